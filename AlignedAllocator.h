@@ -0,0 +1,99 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_ALIGNED_ALLOCATOR_H__
+#define __ECC_ALIGNED_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace ecc
+{
+    // std::allocator only guarantees alignof(std::max_align_t) before C++17,
+    // this one starts every block on a cache line
+    template <typename T, size_t Alignment = 64>
+    class AlignedAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+    public:
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+        {}
+
+        T* allocate(size_t count)
+        {
+            void* ptr = nullptr;
+#if defined(_WIN32)
+            ptr = _aligned_malloc(count * sizeof(T), Alignment);
+#else
+            if (posix_memalign(&ptr, Alignment, count * sizeof(T)) != 0) {
+                ptr = nullptr;
+            }
+#endif
+            if (ptr == nullptr) {
+                throw std::bad_alloc();
+            }
+
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T* ptr, size_t)
+        {
+#if defined(_WIN32)
+            _aligned_free(ptr);
+#else
+            free(ptr);
+#endif
+        }
+    };
+
+    template <typename T, typename U, size_t Alignment>
+    bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, size_t Alignment>
+    bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+        return false;
+    }
+}
+
+#endif
\ No newline at end of file
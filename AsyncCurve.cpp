@@ -0,0 +1,227 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AsyncCurve.h"
+#include "BNContext.h"
+#include "ECAffine.h"
+#include "MPMCQueue.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace ecc;
+
+const size_t AsyncCurve::BATCH;
+const size_t AsyncCurve::CAPACITY;
+
+namespace
+{
+    struct Job {
+        BigNum k;
+        std::unique_ptr<ECPoint> point;
+        AsyncCurve::Completion done;
+    };
+}
+
+struct AsyncCurve::State {
+    std::shared_ptr<const EllipticCurve> curve;
+    MPMCQueue<Job*> queue;
+
+    // runners currently draining, at most one per pool worker
+    std::atomic<size_t> runners;
+    size_t maxRunners;
+
+    State(const std::shared_ptr<const EllipticCurve>& curve, size_t capacity) : curve(curve), queue(capacity), runners(0), maxRunners(ThreadPool::Shared().Size())
+    {}
+
+    ~State()
+    {
+        Job* job = nullptr;
+        while (queue.TryPop(job)) {
+            delete job;
+        }
+    }
+
+    // called after every push. the fence pairs with the one in Drain: either this sees a runner
+    // leaving or that runner sees the new job
+    static void Schedule(const std::shared_ptr<State>& self)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto count = self->runners.load();
+        while (count < self->maxRunners) {
+            if (self->runners.compare_exchange_weak(count, count + 1)) {
+                ThreadPool::Shared().Submit([self]() { self->Drain(); });
+                return;
+            }
+        }
+    }
+
+    void Drain()
+    {
+        std::vector<std::unique_ptr<Job>> batch;
+        batch.reserve(BATCH);
+
+        while (true) {
+            Job* job = nullptr;
+            while ((batch.size() < BATCH) && queue.TryPop(job)) {
+                batch.emplace_back(job);
+            }
+
+            if (batch.empty()) {
+                --runners;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!queue.TryPop(job)) {
+                    return;
+                }
+
+                ++runners;
+                batch.emplace_back(job);
+                continue;
+            }
+
+            Process(batch);
+            batch.clear();
+        }
+    }
+
+    void Process(std::vector<std::unique_ptr<Job>>& batch)
+    {
+        auto& group = *curve->group;
+        auto ctx = BNContext::Get();
+        ECC_METRIC_SCOPE(group, Operation::Multiply, batch.size());
+
+        auto results = std::vector<std::unique_ptr<ECPoint>>(batch.size());
+        auto errors = std::vector<std::exception_ptr>(batch.size());
+        auto raw = std::vector<EC_POINT*>();
+        raw.reserve(batch.size());
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            try {
+                results[i].reset(new ECPoint(curve->group));
+
+                auto& job = *batch[i];
+                auto success = (job.point == nullptr)
+                    ? group.MultiplyGenerator(results[i]->RawPtr(), job.k.RawPtr(), ctx)
+                    : (1 == EC_POINT_mul(group.RawPtr(), results[i]->RawPtr(), nullptr, job.point->RawPtr(), job.k.RawPtr(), ctx));
+
+                if (!success) {
+                    throw std::runtime_error("AsyncCurve: scalar multiplication failed");
+                }
+                raw.push_back(results[i]->RawPtr());
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+
+        // one shared inversion for the batch; the results stay correct without it
+        if (!raw.empty()) {
+            MakeAffine(group.RawPtr(), raw.size(), raw.data(), ctx);
+        }
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            try {
+                batch[i]->done((errors[i] == nullptr) ? results[i].get() : nullptr, errors[i]);
+            } catch (...) {
+            }
+        }
+    }
+};
+
+AsyncCurve::AsyncCurve(const std::shared_ptr<const EllipticCurve>& curve, size_t capacity)
+{
+    if (curve == nullptr) {
+        throw std::invalid_argument("AsyncCurve: curve is null");
+    }
+
+    state = std::make_shared<State>(curve, capacity);
+}
+
+const EllipticCurve& AsyncCurve::Curve() const
+{
+    return *state->curve;
+}
+
+std::future<ECPoint> AsyncCurve::Multiply(const BigNum& k)
+{
+    auto promise = std::make_shared<std::promise<ECPoint>>();
+    auto future = promise->get_future();
+
+    Submit(k, nullptr, [promise](ECPoint* result, std::exception_ptr error) {
+        if (result != nullptr) {
+            promise->set_value(std::move(*result));
+        } else {
+            promise->set_exception(error);
+        }
+    });
+
+    return future;
+}
+
+std::future<ECPoint> AsyncCurve::Multiply(const BigNum& k, const ECPoint& point)
+{
+    auto promise = std::make_shared<std::promise<ECPoint>>();
+    auto future = promise->get_future();
+
+    Submit(k, &point, [promise](ECPoint* result, std::exception_ptr error) {
+        if (result != nullptr) {
+            promise->set_value(std::move(*result));
+        } else {
+            promise->set_exception(error);
+        }
+    });
+
+    return future;
+}
+
+void AsyncCurve::Multiply(const BigNum& k, Completion done)
+{
+    Submit(k, nullptr, std::move(done));
+}
+
+void AsyncCurve::Multiply(const BigNum& k, const ECPoint& point, Completion done)
+{
+    Submit(k, &point, std::move(done));
+}
+
+void AsyncCurve::Submit(const BigNum& k, const ECPoint* point, Completion done)
+{
+    if ((point != nullptr) && (point->GroupHandle() != state->curve->group.get())) {
+        throw std::invalid_argument("AsyncCurve::Multiply: point is not on this curve");
+    }
+
+    std::unique_ptr<Job> job(new Job());
+    job->k = k;
+    job->point.reset(point != nullptr ? new ECPoint(*point) : nullptr);
+    job->done = std::move(done);
+
+    if (!state->queue.TryPush(job.get())) {
+        throw std::runtime_error("AsyncCurve: submission queue is full");
+    }
+    job.release();
+
+    State::Schedule(state);
+}
\ No newline at end of file
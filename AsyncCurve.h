@@ -0,0 +1,139 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_ASYNC_CURVE_H__
+#define __ECC_ASYNC_CURVE_H__
+
+#include "EllipticCurve.h"
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+namespace ecc
+{
+    // AsyncCurve : non-blocking scalar multiplication on the shared thread pool
+    //
+    // jobs go into a lock-free submission queue and are drained in batches of up to BATCH by at most
+    // one runner per pool worker. a batch shares the worker's BN_CTX and one normalization of all its
+    // results, so completed points are affine and cheap to encode. completions run on the worker
+    // that computed the batch; they must not block or throw.
+    class AsyncCurve
+    {
+    public:
+        // result is null exactly when error is set
+        typedef std::function<void(ECPoint* result, std::exception_ptr error)> Completion;
+
+        static const size_t BATCH = 32;
+        static const size_t CAPACITY = 4096;
+
+    private:
+        struct State;
+        std::shared_ptr<State> state;
+
+    public:
+        explicit AsyncCurve(const std::shared_ptr<const EllipticCurve>& curve, size_t capacity = CAPACITY);
+        ~AsyncCurve() = default;
+
+        AsyncCurve(const AsyncCurve&) = delete;
+        AsyncCurve& operator=(const AsyncCurve&) = delete;
+
+        const EllipticCurve& Curve() const;
+
+        // k * G and k * point. these throw std::runtime_error when the submission queue is full
+        std::future<ECPoint> Multiply(const BigNum& k);
+        std::future<ECPoint> Multiply(const BigNum& k, const ECPoint& point);
+
+        void Multiply(const BigNum& k, Completion done);
+        void Multiply(const BigNum& k, const ECPoint& point, Completion done);
+
+#if defined(__cpp_impl_coroutine)
+        class Awaitable
+        {
+        private:
+            AsyncCurve& owner;
+            BigNum k;
+            std::unique_ptr<ECPoint> point;
+            std::unique_ptr<ECPoint> result;
+            std::exception_ptr error;
+
+        public:
+            Awaitable(AsyncCurve& owner, const BigNum& k, const ECPoint* point) : owner(owner), k(k), point(point != nullptr ? new ECPoint(*point) : nullptr)
+            {}
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            // the awaiting coroutine resumes on the pool worker that completed the job
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                auto done = [this, handle](ECPoint* value, std::exception_ptr failure) {
+                    if (value != nullptr) {
+                        result.reset(new ECPoint(std::move(*value)));
+                    }
+                    error = failure;
+                    handle.resume();
+                };
+
+                if (point == nullptr) {
+                    owner.Multiply(k, done);
+                } else {
+                    owner.Multiply(k, *point, done);
+                }
+            }
+
+            ECPoint await_resume()
+            {
+                if (error != nullptr) {
+                    std::rethrow_exception(error);
+                }
+                return std::move(*result);
+            }
+        };
+
+        // co_await curve.MultiplyAsync(k) suspends the caller instead of a thread
+        Awaitable MultiplyAsync(const BigNum& k)
+        {
+            return Awaitable(*this, k, nullptr);
+        }
+
+        Awaitable MultiplyAsync(const BigNum& k, const ECPoint& point)
+        {
+            return Awaitable(*this, k, &point);
+        }
+#endif
+
+    private:
+        void Submit(const BigNum& k, const ECPoint* point, Completion done);
+    };
+}
+
+#endif
\ No newline at end of file
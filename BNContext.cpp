@@ -0,0 +1,68 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BNContext.h"
+#include "Metrics.h"
+#include <new>
+
+using namespace ecc;
+
+namespace
+{
+    class ThreadContext
+    {
+    private:
+        BN_CTX* ctx;
+
+    public:
+        ThreadContext() : ctx(BN_CTX_new())
+        {
+#if defined(ECC_ENABLE_METRICS)
+            Metrics::CountContext();
+#endif
+        }
+
+        ~ThreadContext()
+        {
+            BN_CTX_free(ctx);
+        }
+
+        BN_CTX* RawPtr()
+        {
+            return ctx;
+        }
+    };
+}
+
+BN_CTX* BNContext::Get()
+{
+    static thread_local ThreadContext context;
+
+    auto ctx = context.RawPtr();
+    if (ctx == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ctx;
+}
\ No newline at end of file
@@ -1,79 +1,182 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "BasisConversion.h"
-#include "GF2Polynomial.h"
-
-using namespace ecc;
-
-BasisConversion::BasisConversion(const GF2Polynomial& prime, const BigNum& root) : prime(prime)
-{
-    auto degree = prime.Length() - 1;
-    GF2Polynomial gamma(degree, root);
-
-    for (auto i = 0; i < degree; ++i) {
-        auto row = gamma.Value();
-        matrix.AddRow(row);
-
-        gamma = gamma * gamma;
-        gamma = gamma % prime;
-        gamma = gamma.Expand(degree);
-    }
-
-    invMatrix = matrix.Invert();
-}
-
-BasisConversion& BasisConversion::operator=(const BasisConversion& other) {
-    prime = other.prime;
-    matrix = other.matrix;
-    invMatrix = other.matrix;
-
-    return *this;
-}
-
-BigNum BasisConversion::ConvertPB(const BigNum& num) const
-{
-    if (num.BitLength() > matrix.Rows()) {
-        throw std::invalid_argument("length mismatch between BigNum and GF2Matrix");
-    }
-
-    auto poly = GF2Polynomial(matrix.Rows(), num);
-    poly = poly.ReverseBits();
-    auto converted = poly * matrix;
-
-    return converted.ToBigNum();
-}
-
-BigNum BasisConversion::ConvertNB(const BigNum& num) const
-{
-    if (num.BitLength() > matrix.Rows()) {
-        throw std::invalid_argument("length mismatch between BigNum and GF2Matrix");
-    }
-
-    auto poly = GF2Polynomial(matrix.Rows(), num);
-    auto converted = poly * invMatrix;
-    converted = converted.ReverseBits();
-
-    return converted.ToBigNum();
-}
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BasisConversion.h"
+#include "GF2Polynomial.h"
+#include "ScratchArena.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <string>
+
+using namespace ecc;
+
+BasisConversion::BasisConversion(const GF2Polynomial& prime, const BigNum& root) : modulus(prime), matrix(modulus.Degree(), modulus.Degree())
+{
+    auto degree = modulus.Degree();
+    GF2Polynomial gamma(degree, root);
+
+    // normal basis coordinates are taken most significant bit first, so the rows go in reverse:
+    // row (degree - 1 - i) is root^(2^i). the inverse of the reversed matrix has its columns
+    // reversed as well, so neither direction has to reverse bits at conversion time.
+    for (size_t i = 0; i < degree; ++i) {
+        matrix.SetRow(degree - 1 - i, gamma.Words());
+
+        gamma = modulus.Square(gamma);
+    }
+
+    auto rank = matrix.Invert(invMatrix);
+    if (rank != degree) {
+        throw std::invalid_argument("BasisConversion: root does not generate a normal basis, rank " + std::to_string(rank) + " of " + std::to_string(degree));
+    }
+
+    // both directions run on every conversion, so the Four-Russians tables are built up front
+    matrix.Precompute();
+    invMatrix.Precompute();
+}
+
+// takes matrices built elsewhere, e.g. views into a ConversionCache file
+BasisConversion::BasisConversion(const GF2Polynomial& prime, const GF2Matrix& matrix, const GF2Matrix& invMatrix) : modulus(prime), matrix(matrix), invMatrix(invMatrix)
+{
+    auto degree = modulus.Degree();
+    if ((matrix.Rows() != degree) || (matrix.Cols() != degree) || (invMatrix.Rows() != degree) || (invMatrix.Cols() != degree)) {
+        throw std::invalid_argument("BasisConversion: matrix size does not match the degree of the modulus");
+    }
+
+    if (!this->matrix.HasTables()) {
+        this->matrix.Precompute();
+    }
+
+    if (!this->invMatrix.HasTables()) {
+        this->invMatrix.Precompute();
+    }
+}
+
+BasisConversion& BasisConversion::operator=(const BasisConversion& other) {
+    modulus = other.modulus;
+    matrix = other.matrix;
+    invMatrix = other.invMatrix;
+
+    return *this;
+}
+
+const GF2Modulus& BasisConversion::Modulus() const
+{
+    return modulus;
+}
+
+const GF2Matrix& BasisConversion::Matrix() const
+{
+    return matrix;
+}
+
+const GF2Matrix& BasisConversion::InverseMatrix() const
+{
+    return invMatrix;
+}
+
+size_t BasisConversion::ElementBytes() const
+{
+    return (matrix.Rows() + 7) >> 3;
+}
+
+BigNum BasisConversion::ConvertPB(const BigNum& num) const
+{
+    if (num.BitLength() > matrix.Rows()) {
+        throw std::invalid_argument("length mismatch between BigNum and GF2Matrix");
+    }
+
+    auto bytes = ScratchVector<uint8_t>(ElementBytes());
+    BN_bn2binpad(num.RawPtr(), bytes.data(), bytes.size());
+    Convert(matrix, bytes.data(), bytes.data(), 1);
+
+    return BigNum(BN_bin2bn(bytes.data(), bytes.size(), nullptr));
+}
+
+BigNum BasisConversion::ConvertNB(const BigNum& num) const
+{
+    if (num.BitLength() > matrix.Rows()) {
+        throw std::invalid_argument("length mismatch between BigNum and GF2Matrix");
+    }
+
+    auto bytes = ScratchVector<uint8_t>(ElementBytes());
+    BN_bn2binpad(num.RawPtr(), bytes.data(), bytes.size());
+    Convert(invMatrix, bytes.data(), bytes.data(), 1);
+
+    return BigNum(BN_bin2bn(bytes.data(), bytes.size(), nullptr));
+}
+
+// count elements of ElementBytes() big-endian bytes each; pb and nb may be the same buffer
+void BasisConversion::ConvertPB(const uint8_t* nb, uint8_t* pb, size_t count) const
+{
+    Convert(matrix, nb, pb, count);
+}
+
+void BasisConversion::ConvertNB(const uint8_t* pb, uint8_t* nb, size_t count) const
+{
+    Convert(invMatrix, pb, nb, count);
+}
+
+void BasisConversion::Convert(const GF2Matrix& conversion, const uint8_t* src, uint8_t* dst, size_t count) const
+{
+    const size_t block = 256;
+
+    auto length = ElementBytes();
+    auto words = (conversion.Rows() + 63) >> 6;
+    auto excess = (length << 3) - conversion.Rows();
+
+    for (size_t i = 0; i < count; ++i) {
+        if ((excess != 0) && ((src[i * length] >> (8 - excess)) != 0)) {
+            throw std::invalid_argument("length mismatch between element and GF2Matrix");
+        }
+    }
+
+    auto vectors = ScratchVector<uint64_t>(std::min(count, block) * words);
+    auto results = ScratchVector<uint64_t>(vectors.size());
+
+    for (size_t first = 0; first < count; first += block) {
+        auto n = std::min(block, count - first);
+        std::fill(vectors.begin(), vectors.end(), 0);
+
+        // big-endian bytes to little-endian words
+        for (size_t e = 0; e < n; ++e) {
+            auto bytes = src + (first + e) * length;
+            auto vec = &vectors[e * words];
+            for (size_t k = 0; k < length; ++k) {
+                vec[k >> 3] |= static_cast<uint64_t>(bytes[length - 1 - k]) << ((k & 0x7) << 3);
+            }
+        }
+
+        conversion.Multiply(vectors.data(), results.data(), n);
+
+        for (size_t e = 0; e < n; ++e) {
+            auto bytes = dst + (first + e) * length;
+            auto vec = &results[e * words];
+            for (size_t k = 0; k < length; ++k) {
+                bytes[length - 1 - k] = static_cast<uint8_t>(vec[k >> 3] >> ((k & 0x7) << 3));
+            }
+        }
+    }
+}
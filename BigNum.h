@@ -1,65 +1,72 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#ifndef __ECC_BIG_NUM_H__
-#define __ECC_BIG_NUM_H__
-
-#include <openssl/bn.h>
-#include <vector>
-#include <string>
-
-namespace ecc
-{
-    class BigNum
-    {
-    private:
-        BIGNUM *num;
-
-    public:
-        BigNum();
-        BigNum(const BigNum& other);
-        BigNum(const std::vector<uint8_t>& data);
-        BigNum(BIGNUM* bn);
-        ~BigNum();
-
-        bool Empty() const;
-        size_t BitLength() const;
-
-        BIGNUM* RawPtr();
-        const BIGNUM* RawPtr() const;
-
-        bool operator==(const BigNum& other) const;
-        BigNum& operator=(const BigNum& other);
-
-        BigNum operator+(const BigNum& rhs) const;
-        BigNum operator-(const BigNum& rhs) const;
-        BigNum operator*(const BigNum& rhs) const;
-        BigNum operator%(const BigNum& rhs) const;
-
-        const std::string ToString() const;
-        std::vector<uint8_t> ToByteVector() const;
-    };
-}
-
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_BIG_NUM_H__
+#define __ECC_BIG_NUM_H__
+
+#include <openssl/bn.h>
+#include <vector>
+#include <string>
+
+namespace ecc
+{
+    class BigNum
+    {
+    private:
+        BIGNUM *num;
+
+    public:
+        BigNum();
+        BigNum(const BigNum& other);
+        BigNum(BigNum&& other) noexcept;
+        BigNum(const std::vector<uint8_t>& data);
+        BigNum(BIGNUM* bn);
+        ~BigNum();
+
+        bool Empty() const;
+        size_t BitLength() const;
+
+        BIGNUM* RawPtr();
+        const BIGNUM* RawPtr() const;
+
+        bool operator==(const BigNum& other) const;
+        BigNum& operator=(const BigNum& other);
+        BigNum& operator=(BigNum&& other) noexcept;
+
+        BigNum& operator+=(const BigNum& rhs);
+        BigNum& operator-=(const BigNum& rhs);
+        BigNum& operator*=(const BigNum& rhs);
+        BigNum& operator%=(const BigNum& rhs);
+
+        BigNum operator+(const BigNum& rhs) const;
+        BigNum operator-(const BigNum& rhs) const;
+        BigNum operator*(const BigNum& rhs) const;
+        BigNum operator%(const BigNum& rhs) const;
+
+        const std::string ToString() const;
+        std::vector<uint8_t> ToByteVector() const;
+    };
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ConversionCache.h"
+
+#include <openssl/evp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+#include <vector>
+
+using namespace ecc;
+
+// file layout: FileHeader, modulus bytes, root bytes, then matrix, inverse, matrix tables and
+// inverse tables as native 64-bit words, each section starting on a 64-byte boundary.
+// checksum covers everything after the header and catches truncated or damaged files; it is no
+// defence against tampering, which the owner-only file and directory modes are for
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t degree;
+    uint64_t stride;
+    uint64_t chunkBits;
+    uint64_t modulusBytes;
+    uint64_t rootBytes;
+    uint64_t matrixOffset;
+    uint64_t inverseOffset;
+    uint64_t tablesOffset;
+    uint64_t inverseTablesOffset;
+    uint64_t fileSize;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(FileHeader) == 104, "FileHeader must not contain padding");
+
+static const char MAGIC[8] = { 'E', 'C', 'C', 'B', 'A', 'S', 'I', 'S' };
+static const uint32_t ENDIAN_MARKER = 0x01020304;
+
+static uint64_t AlignLine(uint64_t offset)
+{
+    return (offset + 63) & ~static_cast<uint64_t>(63);
+}
+
+static FileHeader MakeHeader(size_t degree, size_t modulusBytes, size_t rootBytes)
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+
+    auto matrixBytes = static_cast<uint64_t>(degree * GF2Matrix::RowStride(degree)) << 3;
+    auto tableBytes = static_cast<uint64_t>(GF2Matrix::TableLength(degree, degree)) << 3;
+
+    header.version = ConversionCache::VERSION;
+    header.byteOrder = ENDIAN_MARKER;
+    header.degree = degree;
+    header.stride = GF2Matrix::RowStride(degree);
+    header.chunkBits = GF2Matrix::CHUNK_BITS;
+    header.modulusBytes = modulusBytes;
+    header.rootBytes = rootBytes;
+    header.matrixOffset = AlignLine(sizeof(FileHeader) + modulusBytes + rootBytes);
+    header.inverseOffset = header.matrixOffset + matrixBytes;
+    header.tablesOffset = header.inverseOffset + matrixBytes;
+    header.inverseTablesOffset = header.tablesOffset + tableBytes;
+    header.fileSize = header.inverseTablesOffset + tableBytes;
+
+    return header;
+}
+
+static bool WriteAll(int fd, const void* data, size_t length)
+{
+    auto ptr = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        auto written = write(fd, ptr, length);
+        if (written <= 0) {
+            return false;
+        }
+        ptr += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+// four independent lanes of the xxHash64 round over native words, so that the loop runs at memory speed.
+// input is buffered to whole 32-byte stripes, so any split of the same bytes gives the same checksum
+class Checksum
+{
+private:
+    static const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+    static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+
+    uint64_t lanes[4];
+    uint64_t length;
+    uint8_t pending[32];
+
+    static uint64_t Round(uint64_t lane, uint64_t word)
+    {
+        lane += word * PRIME2;
+        lane = (lane << 31) | (lane >> 33);
+        return lane * PRIME1;
+    }
+
+    void Stripe(const uint8_t* data)
+    {
+        uint64_t words[4];
+        std::memcpy(words, data, sizeof(words));
+        for (size_t i = 0; i < 4; ++i) {
+            lanes[i] = Round(lanes[i], words[i]);
+        }
+    }
+
+public:
+    Checksum() : lanes{ PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 }, length(0)
+    {}
+
+    void Update(const void* data, size_t bytes)
+    {
+        auto ptr = static_cast<const uint8_t*>(data);
+        auto used = length & 31;
+        length += bytes;
+
+        if (used != 0) {
+            auto fill = std::min<size_t>(32 - used, bytes);
+            std::memcpy(pending + used, ptr, fill);
+            ptr += fill;
+            bytes -= fill;
+            if (used + fill < 32) {
+                return;
+            }
+            Stripe(pending);
+        }
+
+        for (; bytes >= 32; ptr += 32, bytes -= 32) {
+            Stripe(ptr);
+        }
+        std::memcpy(pending, ptr, bytes);
+    }
+
+    uint64_t Final() const
+    {
+        auto hash = length;
+        for (auto lane : lanes) {
+            hash = (hash ^ Round(0, lane)) * PRIME1;
+        }
+
+        for (size_t i = 0; i < (length & 31); ++i) {
+            hash = (hash ^ pending[i]) * PRIME1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        return hash;
+    }
+};
+
+// the cache is trusted only when no other user can replace its files
+static bool OwnerOnly(const struct stat& status)
+{
+    return (status.st_uid == geteuid()) && ((status.st_mode & (S_IWGRP | S_IWOTH)) == 0);
+}
+
+static bool OwnerOnly(const std::string& directory)
+{
+    struct stat status;
+    return (stat(directory.c_str(), &status) == 0) && S_ISDIR(status.st_mode) && OwnerOnly(status);
+}
+
+ConversionCache::ConversionCache(const std::string& directory) : directory(directory)
+{}
+
+// the file name is the SHA-256 of the length-prefixed modulus and root
+std::string ConversionCache::Path(const BigNum& prime, const BigNum& root) const
+{
+    auto modulus = prime.ToByteVector();
+    auto generator = root.ToByteVector();
+
+    std::vector<uint8_t> key;
+    uint64_t lengths[2] = { modulus.size(), generator.size() };
+    key.insert(key.end(), reinterpret_cast<uint8_t*>(&lengths[0]), reinterpret_cast<uint8_t*>(&lengths[0]) + sizeof(uint64_t));
+    key.insert(key.end(), modulus.begin(), modulus.end());
+    key.insert(key.end(), reinterpret_cast<uint8_t*>(&lengths[1]), reinterpret_cast<uint8_t*>(&lengths[1]) + sizeof(uint64_t));
+    key.insert(key.end(), generator.begin(), generator.end());
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    if (1 != EVP_Digest(key.data(), key.size(), digest, &digestLength, EVP_sha256(), nullptr)) {
+        throw std::runtime_error("ConversionCache: EVP_Digest failed");
+    }
+
+    std::ostringstream oss;
+    oss << directory << "/basis-" << std::hex;
+    for (unsigned int i = 0; i < digestLength; ++i) {
+        oss << std::setfill('0') << std::setw(2) << +digest[i];
+    }
+    oss << ".bin";
+
+    return oss.str();
+}
+
+// returns false when there is no usable file; a file from another version, byte order or key is ignored,
+// and so is one that fails its checksum or that another user could have written
+bool ConversionCache::Load(const BigNum& prime, const BigNum& root, BasisConversion& conversion) const
+{
+    if (!OwnerOnly(directory)) {
+        return false;
+    }
+
+    auto path = Path(prime, root);
+    auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || !OwnerOnly(status) || (static_cast<size_t>(status.st_size) < sizeof(FileHeader))) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = status.st_size;
+    auto addr = mmap(nullptr, size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    auto owner = std::shared_ptr<const void>(addr, [size](const void* ptr) {
+        munmap(const_cast<void*>(ptr), size);
+    });
+
+    auto base = static_cast<const uint8_t*>(addr);
+    auto modulus = prime.ToByteVector();
+    auto generator = root.ToByteVector();
+    auto degree = GF2Polynomial(prime).Length() - 1;
+
+    auto expected = MakeHeader(degree, modulus.size(), generator.size());
+    auto header = FileHeader();
+    std::memcpy(&header, base, sizeof(FileHeader));
+    expected.checksum = header.checksum;
+    if (std::memcmp(&header, &expected, sizeof(FileHeader)) != 0 || (expected.fileSize != size)) {
+        return false;
+    }
+
+    auto key = base + sizeof(FileHeader);
+    if ((std::memcmp(key, modulus.data(), modulus.size()) != 0) || (std::memcmp(key + modulus.size(), generator.data(), generator.size()) != 0)) {
+        return false;
+    }
+
+    // reads every page once; the pages stay shared with other processes mapping the same file
+    Checksum checksum;
+    checksum.Update(key, size - sizeof(FileHeader));
+    if (checksum.Final() != header.checksum) {
+        return false;
+    }
+
+    auto words = [&](uint64_t offset) { return reinterpret_cast<const uint64_t*>(base + offset); };
+    auto matrix = GF2Matrix::View(degree, degree, words(expected.matrixOffset), words(expected.tablesOffset), owner);
+    auto invMatrix = GF2Matrix::View(degree, degree, words(expected.inverseOffset), words(expected.inverseTablesOffset), owner);
+
+    conversion = BasisConversion(prime, matrix, invMatrix);
+
+    return true;
+}
+
+// written to a temporary file and renamed into place, so readers never see a partial file
+bool ConversionCache::Store(const BigNum& prime, const BigNum& root, const BasisConversion& conversion) const
+{
+    auto& matrix = conversion.Matrix();
+    auto& invMatrix = conversion.InverseMatrix();
+    if (!matrix.HasTables() || !invMatrix.HasTables() || !OwnerOnly(directory)) {
+        return false;
+    }
+
+    auto modulus = prime.ToByteVector();
+    auto generator = root.ToByteVector();
+    auto degree = matrix.Rows();
+    auto header = MakeHeader(degree, modulus.size(), generator.size());
+
+    auto path = Path(prime, root);
+    auto tmpPath = std::vector<char>(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    tmpPath.insert(tmpPath.end(), suffix, suffix + sizeof(suffix));
+
+    auto fd = mkstemp(tmpPath.data());
+    if (fd < 0) {
+        return false;
+    }
+
+    auto matrixBytes = header.inverseOffset - header.matrixOffset;
+    auto tableBytes = header.inverseTablesOffset - header.tablesOffset;
+    auto padding = std::vector<uint8_t>(header.matrixOffset - sizeof(FileHeader) - modulus.size() - generator.size(), 0);
+
+    Checksum checksum;
+    checksum.Update(modulus.data(), modulus.size());
+    checksum.Update(generator.data(), generator.size());
+    checksum.Update(padding.data(), padding.size());
+    checksum.Update(matrix.Data(), matrixBytes);
+    checksum.Update(invMatrix.Data(), matrixBytes);
+    checksum.Update(matrix.TableData(), tableBytes);
+    checksum.Update(invMatrix.TableData(), tableBytes);
+    header.checksum = checksum.Final();
+
+    // other users must not be able to replace what Load trusts
+    auto ok = (fchmod(fd, 0600) == 0);
+    ok = ok && WriteAll(fd, &header, sizeof(header));
+    ok = ok && WriteAll(fd, modulus.data(), modulus.size());
+    ok = ok && WriteAll(fd, generator.data(), generator.size());
+    ok = ok && WriteAll(fd, padding.data(), padding.size());
+    ok = ok && WriteAll(fd, matrix.Data(), matrixBytes);
+    ok = ok && WriteAll(fd, invMatrix.Data(), matrixBytes);
+    ok = ok && WriteAll(fd, matrix.TableData(), tableBytes);
+    ok = ok && WriteAll(fd, invMatrix.TableData(), tableBytes);
+    ok = (close(fd) == 0) && ok;
+
+    if (ok) {
+        ok = (std::rename(tmpPath.data(), path.c_str()) == 0);
+    }
+
+    if (!ok) {
+        unlink(tmpPath.data());
+    }
+
+    return ok;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_CONVERSION_CACHE_H__
+#define __ECC_CONVERSION_CACHE_H__
+
+#include "BigNum.h"
+#include "BasisConversion.h"
+
+#include <string>
+#include <cstdint>
+
+namespace ecc
+{
+    // stores the matrices of a BasisConversion, with their Four-Russians tables, in one file per
+    // (modulus, root) under a directory. files are mapped read-only, so processes loading the
+    // same conversion share its pages instead of rebuilding it. the directory and its files must be
+    // writable by their owner only; a checksum in each file guards against damage, not tampering.
+    class ConversionCache
+    {
+    public:
+        static const uint32_t VERSION = 4;
+
+    private:
+        std::string directory;
+
+    public:
+        ConversionCache(const std::string& directory);
+        ~ConversionCache() = default;
+
+        std::string Path(const BigNum& prime, const BigNum& root) const;
+
+        bool Load(const BigNum& prime, const BigNum& root, BasisConversion& conversion) const;
+        bool Store(const BigNum& prime, const BigNum& root, const BasisConversion& conversion) const;
+    };
+}
+
+#endif
\ No newline at end of file
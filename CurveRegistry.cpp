@@ -0,0 +1,157 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CurveRegistry.h"
+#include "ECGroupGFp.h"
+#include "ECGroupGF2m.h"
+
+#include <openssl/ec.h>
+#include <openssl/objects.h>
+#include <openssl/obj_mac.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+using namespace ecc;
+
+namespace
+{
+    class Entry
+    {
+    public:
+        int nid;
+        std::once_flag once;
+        std::shared_ptr<const EllipticCurve> curve;
+
+    public:
+        Entry(int nid) : nid(nid)
+        {}
+    };
+
+    // one entry per curve built into OpenSSL, sorted by nid; never resized after construction
+    class Table
+    {
+    public:
+        std::vector<std::unique_ptr<Entry>> entries;
+
+    public:
+        Table()
+        {
+            auto count = EC_get_builtin_curves(nullptr, 0);
+            auto curves = std::vector<EC_builtin_curve>(count);
+            EC_get_builtin_curves(curves.data(), count);
+
+            for (auto& curve : curves) {
+                entries.emplace_back(new Entry(curve.nid));
+            }
+
+            std::sort(entries.begin(), entries.end(), [](const std::unique_ptr<Entry>& lhs, const std::unique_ptr<Entry>& rhs) {
+                return lhs->nid < rhs->nid;
+            });
+        }
+
+        Entry* Find(int nid) const
+        {
+            auto it = std::lower_bound(entries.begin(), entries.end(), nid, [](const std::unique_ptr<Entry>& entry, int nid) {
+                return entry->nid < nid;
+            });
+
+            return ((it != entries.end()) && ((*it)->nid == nid)) ? it->get() : nullptr;
+        }
+    };
+
+    const Table& Curves()
+    {
+        static const Table table;
+        return table;
+    }
+
+    // the group is kept as OpenSSL built it, so that curves such as P-256 keep their optimized methods
+    // and generator tables. only binary curves get a comb, OpenSSL has no faster generator path for them
+    EllipticCurve Build(int nid)
+    {
+        auto raw = std::unique_ptr<EC_GROUP, decltype(&EC_GROUP_free)>(EC_GROUP_new_by_curve_name(nid), &EC_GROUP_free);
+        if (raw == nullptr) {
+            throw std::runtime_error("CurveRegistry: OpenSSL cannot create curve " + std::string(OBJ_nid2sn(nid)));
+        }
+
+        std::shared_ptr<ECGroup> group;
+        auto binary = (EC_GROUP_get_field_type(raw.get()) == NID_X9_62_characteristic_two_field);
+        if (binary) {
+            group = std::make_shared<ECGroupGF2m>(raw.get());
+        } else {
+            group = std::make_shared<ECGroupGFp>(raw.get());
+        }
+        raw.release();
+
+        if (binary) {
+            group->Precompute();
+        }
+
+        BigNum order(BN_dup(EC_GROUP_get0_order(group->RawPtr())));
+        return EllipticCurve(group, std::make_shared<LazyBasisConversion>(), order);
+    }
+}
+
+std::shared_ptr<const EllipticCurve> CurveRegistry::Get(const std::string& name)
+{
+    auto nid = EC_curve_nist2nid(name.c_str());
+    if (nid == NID_undef) {
+        nid = OBJ_txt2nid(name.c_str());
+    }
+
+    if (nid == NID_undef) {
+        throw std::invalid_argument("CurveRegistry: unknown curve " + name);
+    }
+
+    return Get(nid);
+}
+
+std::shared_ptr<const EllipticCurve> CurveRegistry::Get(int nid)
+{
+    auto entry = Curves().Find(nid);
+    if (entry == nullptr) {
+        throw std::invalid_argument("CurveRegistry: unknown curve nid " + std::to_string(nid));
+    }
+
+    // a failed build leaves the flag unset, so the next lookup tries again
+    std::call_once(entry->once, [entry]() {
+        auto curve = std::make_shared<const EllipticCurve>(Build(entry->nid));
+        ECGroup::Intern(curve->group);
+        entry->curve = curve;
+    });
+
+    return entry->curve;
+}
+
+std::vector<std::string> CurveRegistry::Names()
+{
+    auto names = std::vector<std::string>();
+    for (auto& entry : Curves().entries) {
+        names.push_back(OBJ_nid2sn(entry->nid));
+    }
+
+    return names;
+}
\ No newline at end of file
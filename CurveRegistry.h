@@ -0,0 +1,52 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_CURVE_REGISTRY_H__
+#define __ECC_CURVE_REGISTRY_H__
+
+#include "EllipticCurve.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ecc
+{
+    // CurveRegistry : process-wide named curves, built on first lookup and shared from then on
+    //
+    // a curve is found by its short name (sect409k1, prime256v1), its NIST name (K-409, P-256) or
+    // its OID in dotted form (1.3.132.0.36). the table of curves is fixed at first use and every
+    // entry is built exactly once, so a lookup after that is a search and a std::call_once fast path.
+    // named binary curves carry no normal basis root, their conversion is unavailable.
+    class CurveRegistry
+    {
+    public:
+        static std::shared_ptr<const EllipticCurve> Get(const std::string& name);
+        static std::shared_ptr<const EllipticCurve> Get(int nid);
+
+        static std::vector<std::string> Names();
+    };
+}
+
+#endif
\ No newline at end of file
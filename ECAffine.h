@@ -0,0 +1,42 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_EC_AFFINE_H__
+#define __ECC_EC_AFFINE_H__
+
+#include <openssl/ec.h>
+
+namespace ecc
+{
+    // MakeAffine : brings points to Z = 1 so that later reads and encodings skip the inversion
+    //
+    // prime field points are kept in Jacobian coordinates by OpenSSL, and this normalizes them all
+    // with a single field inversion (Montgomery's trick). binary field points are already affine
+    // in OpenSSL, where this only checks that Z = 1 and costs no inversion.
+    // this is the only caller of the deprecated EC_POINTs_make_affine, which OpenSSL 3 still ships
+    // without a replacement; its warning is suppressed here and nowhere else.
+    bool MakeAffine(const EC_GROUP* group, size_t count, EC_POINT** points, BN_CTX* ctx);
+}
+
+#endif
\ No newline at end of file
@@ -1,64 +1,158 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "ECGroup.h"
-
-using namespace ecc;
-
-ECGroup::ECGroup(size_t fieldSize) : group(nullptr), fieldSize(fieldSize)
-{}
-
-ECGroup::ECGroup(const ECGroup& other)
-{
-    fieldSize = other.fieldSize;
-    group = EC_GROUP_dup(other.group);
-}
-
-ECGroup::~ECGroup()
-{
-    if (group != nullptr) {
-        EC_GROUP_free(group);
-        group = nullptr;
-    }
-}
-
-size_t ECGroup::FieldSize() const
-{
-    return fieldSize;
-}
-
-size_t ECGroup::FieldSizeInBytes() const
-{
-    return (fieldSize + 7) >> 3;
-}
-
-EC_GROUP* ECGroup::RawPtr()
-{
-    return group;
-}
-
-const EC_GROUP* ECGroup::RawPtr() const
-{
-    return group;
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ECGroup.h"
+
+#include <stdexcept>
+#include <openssl/obj_mac.h>
+#include <vector>
+
+using namespace ecc;
+
+ECGroup::ECGroup(size_t fieldSize) : group(nullptr), fieldSize(fieldSize), interned(false)
+{
+#if defined(ECC_ENABLE_METRICS)
+    metrics = std::make_shared<Metrics>();
+#endif
+}
+
+// takes ownership of a group OpenSSL already built, such as a named curve with its own optimized methods
+ECGroup::ECGroup(EC_GROUP* group) : group(group), fieldSize(0), interned(false)
+{
+    if (group == nullptr) {
+        throw std::invalid_argument("ECGroup: group is null");
+    }
+
+    fieldSize = EC_GROUP_get_degree(group);
+#if defined(ECC_ENABLE_METRICS)
+    metrics = std::make_shared<Metrics>();
+#endif
+}
+
+// a copy is a separate group and counts separately
+ECGroup::ECGroup(const ECGroup& other) : std::enable_shared_from_this<ECGroup>(), interned(false)
+{
+    fieldSize = other.fieldSize;
+    group = EC_GROUP_dup(other.group);
+    comb = other.comb;
+#if defined(ECC_ENABLE_METRICS)
+    metrics = std::make_shared<Metrics>();
+#endif
+}
+
+ECGroup::~ECGroup()
+{
+    if (group != nullptr) {
+        EC_GROUP_free(group);
+        group = nullptr;
+    }
+}
+
+size_t ECGroup::FieldSize() const
+{
+    return fieldSize;
+}
+
+size_t ECGroup::FieldSizeInBytes() const
+{
+    return (fieldSize + 7) >> 3;
+}
+
+void ECGroup::Precompute()
+{
+    comb = std::make_shared<FixedBaseComb>(group, Arithmetic());
+}
+
+bool ECGroup::MultiplyGenerator(EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const
+{
+    return 1 == EC_POINT_mul(group, result, k, nullptr, nullptr, ctx);
+}
+
+bool ECGroup::MultiplyGeneratorPublic(EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const
+{
+    if (comb == nullptr) {
+        return 1 == EC_POINT_mul(group, result, k, nullptr, nullptr, ctx);
+    }
+
+    return comb->Multiply(group, result, k, ctx);
+}
+
+const PointDecompressor& ECGroup::Decompressor() const
+{
+    std::call_once(decompressorOnce, [this]() {
+        decompressor = std::make_shared<PointDecompressor>(group);
+    });
+
+    return *decompressor;
+}
+
+std::shared_ptr<const LopezDahab> ECGroup::Arithmetic() const
+{
+    std::call_once(arithmeticOnce, [this]() {
+        if (EC_GROUP_get_field_type(group) == NID_X9_62_characteristic_two_field) {
+            arithmetic = std::make_shared<const LopezDahab>(group);
+        }
+    });
+
+    return arithmetic;
+}
+
+void ECGroup::Intern(const std::shared_ptr<ECGroup>& group)
+{
+    if (group == nullptr) {
+        throw std::invalid_argument("ECGroup: group is null");
+    }
+
+    if (!group->interned.load(std::memory_order_acquire)) {
+        // never destroyed, so that points freed during static destruction still find their group
+        static auto groups = new std::vector<std::shared_ptr<ECGroup>>();
+        static std::mutex mutex;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!group->interned.load(std::memory_order_relaxed)) {
+            groups->push_back(group);
+            group->interned.store(true, std::memory_order_release);
+        }
+    }
+}
+
+bool ECGroup::IsInterned() const
+{
+    return interned.load(std::memory_order_acquire);
+}
+
+Metrics* ECGroup::Recorder() const
+{
+    return metrics.get();
+}
+
+EC_GROUP* ECGroup::RawPtr()
+{
+    return group;
+}
+
+const EC_GROUP* ECGroup::RawPtr() const
+{
+    return group;
 }
\ No newline at end of file
@@ -1,53 +1,99 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#ifndef __ECC_EC_GROUP_H__
-#define __ECC_EC_GROUP_H__
-
-#include <openssl/ec.h>
-#include "BigNum.h"
-
-namespace ecc
-{
-    class ECGroup {
-    protected:
-        EC_GROUP* group;
-        size_t fieldSize;
-
-    public:
-        ECGroup(size_t fieldSize);
-        ECGroup(const ECGroup& other);
-        virtual ~ECGroup();
-
-        virtual bool SetParameters(const BigNum& p, const BigNum& order, const BigNum& a, const BigNum& b, const BigNum& x, const BigNum& y) = 0;
-
-        size_t FieldSize() const;
-        size_t FieldSizeInBytes() const;
-
-        EC_GROUP* RawPtr();
-        const EC_GROUP* RawPtr() const;
-    };
-}
-
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_EC_GROUP_H__
+#define __ECC_EC_GROUP_H__
+
+#include <openssl/ec.h>
+#include "BigNum.h"
+#include "FixedBaseComb.h"
+#include "LopezDahab.h"
+#include "PointDecompressor.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace ecc
+{
+    class ECGroup : public std::enable_shared_from_this<ECGroup> {
+    protected:
+        EC_GROUP* group;
+        size_t fieldSize;
+        std::shared_ptr<FixedBaseComb> comb;
+
+        // built on the first batch decompression
+        mutable std::once_flag decompressorOnce;
+        mutable std::shared_ptr<PointDecompressor> decompressor;
+
+        // binary fields only, built on first use and shared by the comb and multi-scalar multiplication
+        mutable std::once_flag arithmeticOnce;
+        mutable std::shared_ptr<const LopezDahab> arithmetic;
+
+        // null unless built with ECC_ENABLE_METRICS
+        std::shared_ptr<Metrics> metrics;
+
+        // set once Intern holds the group, read on every point construction
+        std::atomic<bool> interned;
+
+    public:
+        ECGroup(size_t fieldSize);
+        ECGroup(EC_GROUP* group);
+        ECGroup(const ECGroup& other);
+        virtual ~ECGroup();
+
+        virtual bool SetParameters(const BigNum& p, const BigNum& order, const BigNum& a, const BigNum& b, const BigNum& x, const BigNum& y) = 0;
+
+        size_t FieldSize() const;
+        size_t FieldSizeInBytes() const;
+
+        void Precompute();
+
+        // k * G with OpenSSL's constant time ladder, or the precomputed tables of a named curve
+        bool MultiplyGenerator(EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const;
+
+        // k * G with the comb of Precompute, whose timing depends on k; for public scalars only.
+        // without a comb it is MultiplyGenerator
+        bool MultiplyGeneratorPublic(EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const;
+
+        const PointDecompressor& Decompressor() const;
+
+        // null for prime fields
+        std::shared_ptr<const LopezDahab> Arithmetic() const;
+
+        // keeps the group alive for the rest of the process, so that points on it refer to it by plain
+        // pointer and copies never touch a reference count. meant for the groups of CurveRegistry; points
+        // on any other group hold a reference, so that the group goes away with its last curve and point
+        static void Intern(const std::shared_ptr<ECGroup>& group);
+        bool IsInterned() const;
+
+        Metrics* Recorder() const;
+
+        EC_GROUP* RawPtr();
+        const EC_GROUP* RawPtr() const;
+    };
+}
+
 #endif
\ No newline at end of file
@@ -1,130 +1,254 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "ECPoint.h"
-#include <openssl/err.h>
-
-using namespace ecc;
-
-ECPoint::ECPoint(const ECPoint& other) : ECPoint(other.group, EC_POINT_dup(other.point, other.group->RawPtr()))
-{}
-
-ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group) : ECPoint(group, EC_POINT_new(group->RawPtr()))
-{}
-
-ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group, EC_POINT* point) : group(group), point(point), x(BigNum(BN_new())), y(BigNum(BN_new()))
-{
-    EC_POINT_get_affine_coordinates_GF2m(group->RawPtr(), point, x.RawPtr(), y.RawPtr(), NULL);
-}
-
-ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group, const BigNum& x, const BigNum& y) : group(group), point(EC_POINT_new(group->RawPtr()))
-{
-    EC_POINT_set_affine_coordinates_GF2m(group->RawPtr(), point, x.RawPtr(), y.RawPtr(), NULL);
-}
-
-ECPoint::~ECPoint()
-{
-    if (point != nullptr) {
-        EC_POINT_free(point);
-        point = nullptr;
-    }
-}
-
-ECPoint& ECPoint::operator=(const ECPoint& other)
-{
-    if (this == &other) {
-        return *this;
-    }
-
-    group = other.group;
-    if (point != nullptr) {
-        EC_POINT_free(point);
-        point = nullptr;
-    }
-
-    point = EC_POINT_dup(other.point, group->RawPtr());
-    x = other.x;
-    y = other.y;
-
-    return *this;
-}
-
-ECPoint ECPoint::operator+(const ECPoint& other) const
-{
-    if (group != other.Group()) {
-        throw std::invalid_argument("ECPoint add: two points are not on the same curve");
-    }
-
-    EC_POINT* result = EC_POINT_new(group->RawPtr());
-    EC_POINT_add(group->RawPtr(), result, point, other.point, NULL);
-    return ECPoint(group, result);
-}
-
-ECPoint ECPoint::operator*(const BigNum& num) const
-{
-    EC_POINT* result = EC_POINT_new(group->RawPtr());
-    auto tmp = EC_POINT_mul(group->RawPtr(), result, NULL, point, num.RawPtr(), nullptr);
-
-    if (tmp == 0) {
-        auto err = ERR_get_error();
-        throw std::runtime_error(std::string("BigNum * ECPoint: ") + ERR_reason_error_string(err));
-    }
-
-    return ECPoint(group, result);
-}
-
-std::shared_ptr<ECGroup> ECPoint::Group() const
-{
-    return group;
-}
-
-EC_POINT* ECPoint::RawPtr()
-{
-    return point;
-}
-
-const EC_POINT* ECPoint::RawPtr() const
-{
-    return point;
-}
-
-BigNum ECPoint::XCoord() const
-{
-    return x;
-}
-
-BigNum ECPoint::YCoord() const
-{
-    return y;
-}
-
-const std::string ECPoint::ToString() const
-{
-    return "(" + x.ToString() + ", " + y.ToString() + ")";
-}
-
-ECPoint ecc::operator*(const BigNum& num, const ECPoint& point)
-{
-    return point * num;
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ECPoint.h"
+#include "BNContext.h"
+#include <openssl/err.h>
+
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace ecc;
+
+namespace
+{
+    // ECPoint::state
+    enum : uint8_t { PROJECTIVE, PUBLISHING, AFFINE };
+
+    // the reference a point keeps on its group, none for interned groups
+    std::shared_ptr<ECGroup> Owner(const std::shared_ptr<ECGroup>& group)
+    {
+        if (group == nullptr) {
+            throw std::invalid_argument("ECPoint: group is null");
+        }
+
+        return group->IsInterned() ? nullptr : group;
+    }
+}
+
+ECPoint::ECPoint(const ECPoint& other) : ECPoint(other.group, other.owner, EC_POINT_dup(other.point, other.group->RawPtr()))
+{
+    if (other.state.load(std::memory_order_acquire) == AFFINE) {
+        x = other.x;
+        y = other.y;
+        state.store(AFFINE, std::memory_order_relaxed);
+    }
+}
+
+ECPoint::ECPoint(ECPoint&& other) noexcept : group(other.group), owner(std::move(other.owner)), point(other.point), state(other.state.load(std::memory_order_relaxed)), x(std::move(other.x)), y(std::move(other.y))
+{
+    other.point = nullptr;
+    other.state.store(PROJECTIVE, std::memory_order_relaxed);
+}
+
+ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group) : ECPoint(group, EC_POINT_new(group->RawPtr()))
+{}
+
+ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group, EC_POINT* point) : ECPoint(group.get(), Owner(group), point)
+{}
+
+ECPoint::ECPoint(ECGroup* group, const std::shared_ptr<ECGroup>& owner, EC_POINT* point) : group(group), owner(owner), point(point), state(PROJECTIVE)
+{}
+
+ECPoint::ECPoint(const std::shared_ptr<ECGroup>& group, BigNum x, BigNum y) : group(group.get()), owner(Owner(group)), point(EC_POINT_new(group->RawPtr())), state(AFFINE), x(std::move(x)), y(std::move(y))
+{
+    EC_POINT_set_affine_coordinates(group->RawPtr(), point, this->x.RawPtr(), this->y.RawPtr(), BNContext::Get());
+}
+
+ECPoint::~ECPoint()
+{
+    if (point != nullptr) {
+        EC_POINT_free(point);
+        point = nullptr;
+    }
+}
+
+ECPoint& ECPoint::operator=(const ECPoint& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    group = other.group;
+    owner = other.owner;
+    if (point != nullptr) {
+        EC_POINT_free(point);
+        point = nullptr;
+    }
+
+    point = EC_POINT_dup(other.point, group->RawPtr());
+    state.store(PROJECTIVE, std::memory_order_relaxed);
+    if (other.state.load(std::memory_order_acquire) == AFFINE) {
+        x = other.x;
+        y = other.y;
+        state.store(AFFINE, std::memory_order_relaxed);
+    }
+
+    return *this;
+}
+
+ECPoint& ECPoint::operator=(ECPoint&& other) noexcept
+{
+    std::swap(group, other.group);
+    std::swap(owner, other.owner);
+    std::swap(point, other.point);
+    auto tmp = state.load(std::memory_order_relaxed);
+    state.store(other.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.state.store(tmp, std::memory_order_relaxed);
+    std::swap(x, other.x);
+    std::swap(y, other.y);
+
+    return *this;
+}
+
+ECPoint& ECPoint::operator+=(const ECPoint& other)
+{
+    ECC_METRIC_SCOPE(*group, Operation::Add, 1);
+
+    if (group != other.group) {
+        throw std::invalid_argument("ECPoint add: two points are not on the same curve");
+    }
+
+    state.store(PROJECTIVE, std::memory_order_relaxed);
+    if (1 != EC_POINT_add(group->RawPtr(), point, point, other.point, BNContext::Get())) {
+        auto err = ERR_get_error();
+        throw std::runtime_error(std::string("ECPoint += ECPoint: ") + ERR_reason_error_string(err));
+    }
+
+    return *this;
+}
+
+ECPoint& ECPoint::operator*=(const BigNum& num)
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, 1);
+
+    state.store(PROJECTIVE, std::memory_order_relaxed);
+    if (1 != EC_POINT_mul(group->RawPtr(), point, nullptr, point, num.RawPtr(), BNContext::Get())) {
+        auto err = ERR_get_error();
+        throw std::runtime_error(std::string("ECPoint *= BigNum: ") + ERR_reason_error_string(err));
+    }
+
+    return *this;
+}
+
+ECPoint ECPoint::operator+(const ECPoint& other) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Add, 1);
+
+    if (group != other.group) {
+        throw std::invalid_argument("ECPoint add: two points are not on the same curve");
+    }
+
+    EC_POINT* result = EC_POINT_new(group->RawPtr());
+    EC_POINT_add(group->RawPtr(), result, point, other.point, BNContext::Get());
+    return ECPoint(group, owner, result);
+}
+
+ECPoint ECPoint::operator*(const BigNum& num) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, 1);
+
+    EC_POINT* result = EC_POINT_new(group->RawPtr());
+    auto tmp = EC_POINT_mul(group->RawPtr(), result, NULL, point, num.RawPtr(), BNContext::Get());
+
+    if (tmp == 0) {
+        auto err = ERR_get_error();
+        throw std::runtime_error(std::string("BigNum * ECPoint: ") + ERR_reason_error_string(err));
+    }
+
+    return ECPoint(group, owner, result);
+}
+
+std::shared_ptr<ECGroup> ECPoint::Group() const
+{
+    return group->shared_from_this();
+}
+
+ECGroup* ECPoint::GroupHandle() const
+{
+    return group;
+}
+
+// the caller may modify the point, so cached coordinates are dropped
+EC_POINT* ECPoint::RawPtr()
+{
+    state.store(PROJECTIVE, std::memory_order_relaxed);
+    return point;
+}
+
+const EC_POINT* ECPoint::RawPtr() const
+{
+    return point;
+}
+
+BigNum ECPoint::XCoord() const
+{
+    Materialize();
+    return x;
+}
+
+BigNum ECPoint::YCoord() const
+{
+    Materialize();
+    return y;
+}
+
+const std::string ECPoint::ToString() const
+{
+    Materialize();
+    return "(" + x.ToString() + ", " + y.ToString() + ")";
+}
+
+// const readers may call this concurrently. each computes into locals and only one publishes them;
+// the others wait out the two moves instead of writing x and y a second time
+void ECPoint::Materialize() const
+{
+    if (state.load(std::memory_order_acquire) == AFFINE) {
+        return;
+    }
+
+    ECC_METRIC_SCOPE(*group, Operation::Invert, 1);
+
+    auto ax = BigNum(BN_new());
+    auto ay = BigNum(BN_new());
+    EC_POINT_get_affine_coordinates(group->RawPtr(), point, ax.RawPtr(), ay.RawPtr(), BNContext::Get());
+
+    uint8_t expected = PROJECTIVE;
+    if (state.compare_exchange_strong(expected, PUBLISHING, std::memory_order_acquire)) {
+        x = std::move(ax);
+        y = std::move(ay);
+        state.store(AFFINE, std::memory_order_release);
+        return;
+    }
+
+    while (state.load(std::memory_order_acquire) != AFFINE) {
+        std::this_thread::yield();
+    }
+}
+
+ECPoint ecc::operator*(const BigNum& num, const ECPoint& point)
+{
+    return point * num;
 }
\ No newline at end of file
@@ -1,163 +1,603 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "EllipticCurve.h"
-#include "ECGroupGF2m.h"
-
-using namespace ecc;
-
-EllipticCurve::EllipticCurve(const std::shared_ptr<ECGroup>& group, const BasisConversion& conversion, const BigNum& order) : group(group), conversion(conversion), order(order)
-{
-}
-
-EllipticCurve::EllipticCurve(const EllipticCurve& other) : EllipticCurve(other.group, other.conversion, other.order)
-{}
-
-EllipticCurve& EllipticCurve::operator=(const EllipticCurve& other)
-{
-    this->group = other.group;
-    this->conversion = other.conversion;
-    this->order = other.order;
-
-    return *this;
-}
-
-BigNum EllipticCurve::RandomScalar()
-{
-    BIGNUM *k = BN_new();
-
-    BN_pseudo_rand(k, group->FieldSize(), 0, 0);
-
-    return BigNum(k);
-}
-
-BigNum EllipticCurve::Normalize(const BigNum& num) const
-{
-    return num % order;
-}
-
-ECPoint EllipticCurve::RandomPoint()
-{
-    auto k = RandomScalar();
-    return Multiply(k);
-}
-
-ECPoint EllipticCurve::Multiply(const BigNum& k)
-{
-    EC_POINT* point = EC_POINT_new(group->RawPtr());
-
-    EC_POINT_mul(group->RawPtr(), point, k.RawPtr(), nullptr, nullptr, nullptr);
-
-    return ECPoint(group, point);
-}
-
-ECPoint EllipticCurve::Point(const std::vector<uint8_t>& rawData)
-{
-    EC_POINT* point = EC_POINT_new(group->RawPtr());
-
-    EC_POINT_oct2point(group->RawPtr(), point, rawData.data(), rawData.size(), nullptr);
-
-    return ECPoint(group, point);
-}
-
-// ybit = 0 -> 0x02
-// ybit = 1 -> 0x03
-ECPoint EllipticCurve::Point(const std::vector<uint8_t>& x, uint8_t ybit)
-{
-    auto bnx = BigNum(x);
-    EC_POINT* point = EC_POINT_new(group->RawPtr());
-
-    EC_POINT_set_compressed_coordinates(group->RawPtr(), point, bnx.RawPtr(), ybit & 0x1, nullptr);
-
-    return ECPoint(group, point);
-}
-
-std::vector<uint8_t> EllipticCurve::Point2Vec(const ECPoint& point)
-{
-    auto len = group->FieldSizeInBytes() * 2 + 1;
-    std::vector<uint8_t> vec(len);
-    EC_POINT_point2oct(group->RawPtr(), point.RawPtr(), point_conversion_form_t::POINT_CONVERSION_UNCOMPRESSED, vec.data(), len, nullptr);
-
-    return vec;
-}
-
-std::vector<uint8_t> EllipticCurve::Point2VecCompressed(const ECPoint& point)
-{
-    auto len = group->FieldSizeInBytes() + 1;
-    std::vector<uint8_t> vec(len);
-    EC_POINT_point2oct(group->RawPtr(), point.RawPtr(), point_conversion_form_t::POINT_CONVERSION_COMPRESSED, vec.data(), len, nullptr);
-
-    return vec;
-}
-
-BigNum EllipticCurve::Add(const BigNum& lhs, const BigNum& rhs) const
-{
-    return (lhs + rhs) % order;
-}
-
-ECPoint EllipticCurve::Add(const ECPoint& lhs, const ECPoint& rhs) const
-{
-    return (lhs + rhs);
-}
-
-ECPoint EllipticCurve::Multiply(const BigNum& lhs, const ECPoint& rhs) const
-{
-    return (lhs * rhs);
-}
-
-bool EllipticCurve::IsValidPoint(const ECPoint& point) const
-{
-    return 1 == EC_POINT_is_on_curve(group->RawPtr(), point.RawPtr(), nullptr);
-}
-
-BigNum EllipticCurve::ConvertPB(const BigNum& nb) const
-{
-    return conversion.ConvertPB(nb);
-}
-
-BigNum EllipticCurve::ConvertNB(const BigNum& pb) const
-{
-    return conversion.ConvertNB(pb);
-}
-
-std::pair<BigNum, BigNum> EllipticCurve::ConvertNB(const ECPoint& point) const
-{
-    auto nbX = conversion.ConvertNB(point.XCoord());
-    auto nbY = conversion.ConvertNB(point.YCoord());
-
-    return std::make_pair<>(nbX, nbY);
-}
-
-ECPoint EllipticCurve::ConvertPB(const std::vector<uint8_t>& nbX, uint8_t ybit) const
-{
-    auto nbY = conversion.ConvertPB(nbX);
-    return ConvertPB(nbX, nbY);
-}
-
-ECPoint EllipticCurve::ConvertPB(const BigNum& nbX, const BigNum& nbY) const
-{
-    auto x = conversion.ConvertPB(nbX);
-    auto y = conversion.ConvertPB(nbY);
-    return ECPoint(group, x, y);
-}
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "EllipticCurve.h"
+#include "ECGroupGF2m.h"
+#include "BNContext.h"
+#include "MultiScalar.h"
+#include "Parallel.h"
+#include "Metrics.h"
+#include "ScratchArena.h"
+#include "ECAffine.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <openssl/obj_mac.h>
+
+using namespace ecc;
+
+EllipticCurve::EllipticCurve(const std::shared_ptr<ECGroup>& group, const BasisConversion& conversion, const BigNum& order) : group(group), conversion(std::make_shared<LazyBasisConversion>(conversion)), order(order)
+{
+}
+
+EllipticCurve::EllipticCurve(const std::shared_ptr<ECGroup>& group, const std::shared_ptr<LazyBasisConversion>& conversion, const BigNum& order) : group(group), conversion(conversion), order(order)
+{
+}
+
+EllipticCurve::EllipticCurve(const EllipticCurve& other) : EllipticCurve(other.group, other.conversion, other.order)
+{}
+
+EllipticCurve& EllipticCurve::operator=(const EllipticCurve& other)
+{
+    this->group = other.group;
+    this->conversion = other.conversion;
+    this->order = other.order;
+
+    return *this;
+}
+
+BigNum EllipticCurve::RandomScalar() const
+{
+    BIGNUM *k = BN_new();
+
+    BN_pseudo_rand(k, group->FieldSize(), 0, 0);
+
+    return BigNum(k);
+}
+
+BigNum EllipticCurve::Normalize(const BigNum& num) const
+{
+    return num % order;
+}
+
+ECPoint EllipticCurve::RandomPoint() const
+{
+    auto k = RandomScalar();
+    return Multiply(k);
+}
+
+ECPoint EllipticCurve::Multiply(const BigNum& k) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, 1);
+
+    ECPoint point(group);
+    if (!group->MultiplyGenerator(point.RawPtr(), k.RawPtr(), BNContext::Get())) {
+        throw std::runtime_error("EllipticCurve::Multiply: EC_POINT_mul failed");
+    }
+
+    return point;
+}
+
+ECPoint EllipticCurve::MultiplyPublic(const BigNum& k) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, 1);
+
+    ECPoint point(group);
+    if (!group->MultiplyGeneratorPublic(point.RawPtr(), k.RawPtr(), BNContext::Get())) {
+        throw std::runtime_error("EllipticCurve::MultiplyPublic: failed");
+    }
+
+    return point;
+}
+
+ECPoint EllipticCurve::Point(const std::vector<uint8_t>& rawData) const
+{
+    EC_POINT* point = EC_POINT_new(group->RawPtr());
+
+    EC_POINT_oct2point(group->RawPtr(), point, rawData.data(), rawData.size(), BNContext::Get());
+
+    return ECPoint(group, point);
+}
+
+// ybit = 0 -> 0x02
+// ybit = 1 -> 0x03
+ECPoint EllipticCurve::Point(const std::vector<uint8_t>& x, uint8_t ybit) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Decompress, 1);
+
+    auto bnx = BigNum(x);
+    EC_POINT* point = EC_POINT_new(group->RawPtr());
+
+    EC_POINT_set_compressed_coordinates(group->RawPtr(), point, bnx.RawPtr(), ybit & 0x1, BNContext::Get());
+
+    return ECPoint(group, point);
+}
+
+std::vector<uint8_t> EllipticCurve::Point2Vec(const ECPoint& point) const
+{
+    auto len = group->FieldSizeInBytes() * 2 + 1;
+    std::vector<uint8_t> vec(len);
+    EC_POINT_point2oct(group->RawPtr(), point.RawPtr(), point_conversion_form_t::POINT_CONVERSION_UNCOMPRESSED, vec.data(), len, BNContext::Get());
+
+    return vec;
+}
+
+std::vector<uint8_t> EllipticCurve::Point2VecCompressed(const ECPoint& point) const
+{
+    auto len = group->FieldSizeInBytes() + 1;
+    std::vector<uint8_t> vec(len);
+    EC_POINT_point2oct(group->RawPtr(), point.RawPtr(), point_conversion_form_t::POINT_CONVERSION_COMPRESSED, vec.data(), len, BNContext::Get());
+
+    return vec;
+}
+
+// brings all points to Z = 1. prime field points share a single field inversion (Montgomery's trick);
+// OpenSSL keeps binary field points affine already, so for them this is a check and no inversion
+void EllipticCurve::MakeAffine(std::vector<ECPoint>& points) const
+{
+    MakeAffine(points.data(), points.size());
+}
+
+void EllipticCurve::MakeAffine(ECPoint* points, size_t count) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Invert, count);
+
+    if (count == 0) {
+        return;
+    }
+
+    ScratchVector<EC_POINT*> rawPoints;
+    rawPoints.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (points[i].GroupHandle() != group.get()) {
+            throw std::invalid_argument("EllipticCurve::MakeAffine: point is not on this curve");
+        }
+        rawPoints.push_back(points[i].RawPtr());
+    }
+
+    if (!ecc::MakeAffine(group->RawPtr(), rawPoints.size(), rawPoints.data(), BNContext::Get())) {
+        throw std::runtime_error("EllipticCurve::MakeAffine: EC_POINTs_make_affine failed");
+    }
+}
+
+// SEC 1 octet string length of a finite point, the same for every point of the curve
+size_t EllipticCurve::EncodedLength(bool compressed) const
+{
+    return group->FieldSizeInBytes() * (compressed ? 1 : 2) + 1;
+}
+
+void EllipticCurve::Encode(std::vector<ECPoint>& points, uint8_t* out, size_t length, bool compressed) const
+{
+    Encode(points.data(), points.size(), out, length, compressed);
+}
+
+// writes the points back to back, EncodedLength(compressed) bytes each. the points are made affine
+// together first, and for binary curves the y bits of a block share a single inversion as well.
+void EllipticCurve::Encode(ECPoint* points, size_t count, uint8_t* out, size_t length, bool compressed) const
+{
+    const size_t block = 256;
+
+    auto stride = EncodedLength(compressed);
+    if (length < count * stride) {
+        throw std::invalid_argument("EllipticCurve::Encode: output buffer is too short");
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if ((points[i].GroupHandle() == group.get()) && EC_POINT_is_at_infinity(group->RawPtr(), points[i].RawPtr())) {
+            throw std::invalid_argument("EllipticCurve::Encode: the point at infinity has no fixed length encoding");
+        }
+    }
+
+    MakeAffine(points, count);
+
+    auto fieldBytes = group->FieldSizeInBytes();
+    auto ctx = BNContext::Get();
+    auto xs = std::vector<BIGNUM*>(std::min(count, block));
+    auto ys = std::vector<BIGNUM*>(xs.size());
+    auto bits = std::vector<uint8_t>(xs.size());
+
+    for (size_t first = 0; first < count; first += block) {
+        auto n = std::min(block, count - first);
+
+        BN_CTX_start(ctx);
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = BN_CTX_get(ctx);
+            ys[i] = BN_CTX_get(ctx);
+        }
+
+        if (ys[n - 1] == nullptr) {
+            BN_CTX_end(ctx);
+            throw std::runtime_error("EllipticCurve::Encode: BN_CTX_get failed");
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const ECPoint& point = points[first + i];
+            EC_POINT_get_affine_coordinates(group->RawPtr(), point.RawPtr(), xs[i], ys[i], ctx);
+        }
+
+        if (compressed) {
+            xs.resize(n);
+            ys.resize(n);
+            CompressedBits(xs, ys, bits.data(), ctx);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            auto dst = out + (first + i) * stride;
+            BN_bn2binpad(xs[i], dst + 1, fieldBytes);
+
+            if (compressed) {
+                dst[0] = 0x02 | bits[i];
+            } else {
+                dst[0] = 0x04;
+                BN_bn2binpad(ys[i], dst + 1 + fieldBytes, fieldBytes);
+            }
+        }
+
+        BN_CTX_end(ctx);
+    }
+}
+
+// parses length / EncodedLength bytes of points all in the form of the first one. entries already in
+// points that belong to this curve are overwritten in place, so a reused vector allocates nothing.
+// compressed points are recovered in bulk by the decompressor of the group, split over threads
+void EllipticCurve::Decode(const uint8_t* data, size_t length, std::vector<ECPoint>& points, size_t threads) const
+{
+    if (length == 0) {
+        points.clear();
+        return;
+    }
+
+    auto compressed = (data[0] == 0x02) || (data[0] == 0x03);
+    auto stride = EncodedLength(compressed);
+    if ((length % stride) != 0) {
+        throw std::invalid_argument("EllipticCurve::Decode: input length is not a multiple of the point length");
+    }
+
+    auto count = length / stride;
+    ECC_METRIC_SCOPE(*group, compressed ? Operation::Decompress : Operation::Validate, count);
+
+    if (points.size() > count) {
+        points.erase(points.begin() + count, points.end());
+    }
+    points.reserve(count);
+
+    auto rawPoints = ScratchVector<EC_POINT*>(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (i == points.size()) {
+            points.emplace_back(group);
+        } else if (points[i].GroupHandle() != group.get()) {
+            points[i] = ECPoint(group);
+        }
+        rawPoints[i] = points[i].RawPtr();
+    }
+
+    auto decompressor = compressed ? &group->Decompressor() : nullptr;
+    ParallelFor(count, threads, [&](size_t begin, size_t end) {
+        auto ctx = BNContext::Get();
+        auto rawGroup = group->RawPtr();
+        auto src = data + begin * stride;
+
+        size_t decoded = 0;
+        if (decompressor != nullptr) {
+            decoded = decompressor->Decompress(rawGroup, src, end - begin, &rawPoints[begin], ctx);
+        } else {
+            while ((decoded < end - begin) && (1 == EC_POINT_oct2point(rawGroup, rawPoints[begin + decoded], src + decoded * stride, stride, ctx))) {
+                ++decoded;
+            }
+        }
+
+        if (decoded != end - begin) {
+            throw std::invalid_argument("EllipticCurve::Decode: point " + std::to_string(begin + decoded) + " is not a valid point of this curve");
+        }
+    });
+}
+
+// the SEC 1 y bit: the parity of y over a prime field, the low bit of y / x over a binary field,
+// where the inverses of all x come out of one inversion (Montgomery's trick)
+void EllipticCurve::CompressedBits(const std::vector<BIGNUM*>& xs, const std::vector<BIGNUM*>& ys, uint8_t* bits, BN_CTX* ctx) const
+{
+    auto n = xs.size();
+    if (EC_GROUP_get_field_type(group->RawPtr()) != NID_X9_62_characteristic_two_field) {
+        for (size_t i = 0; i < n; ++i) {
+            bits[i] = BN_is_odd(ys[i]) ? 1 : 0;
+        }
+        return;
+    }
+
+    BN_CTX_start(ctx);
+    auto p = BN_CTX_get(ctx);
+    auto inv = BN_CTX_get(ctx);
+    auto t = BN_CTX_get(ctx);
+    auto prefix = ScratchVector<BIGNUM*>(n);
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i] = BN_CTX_get(ctx);
+    }
+
+    if ((n == 0) || (prefix[n - 1] == nullptr)) {
+        BN_CTX_end(ctx);
+        return;
+    }
+
+    EC_GROUP_get_curve(group->RawPtr(), p, nullptr, nullptr, ctx);
+
+    // x = 0 only at the point of order two, whose y bit is 0; it is left out of the products
+    BN_one(t);
+    for (size_t i = 0; i < n; ++i) {
+        if (!BN_is_zero(xs[i])) {
+            BN_GF2m_mod_mul(t, t, xs[i], p, ctx);
+        }
+        BN_copy(prefix[i], t);
+    }
+
+    BN_GF2m_mod_inv(inv, t, p, ctx);
+
+    for (size_t i = n; i-- > 0;) {
+        if (BN_is_zero(xs[i])) {
+            bits[i] = 0;
+            continue;
+        }
+
+        // inv holds (x_0 ... x_i)^-1 here
+        if (i > 0) {
+            BN_GF2m_mod_mul(t, inv, prefix[i - 1], p, ctx);
+        } else {
+            BN_copy(t, inv);
+        }
+        BN_GF2m_mod_mul(inv, inv, xs[i], p, ctx);
+
+        BN_GF2m_mod_mul(t, t, ys[i], p, ctx);
+        bits[i] = BN_is_odd(t) ? 1 : 0;
+    }
+
+    BN_CTX_end(ctx);
+}
+
+BigNum EllipticCurve::Add(const BigNum& lhs, const BigNum& rhs) const
+{
+    auto sum = lhs + rhs;
+    sum %= order;
+    return sum;
+}
+
+ECPoint EllipticCurve::Add(const ECPoint& lhs, const ECPoint& rhs) const
+{
+    return (lhs + rhs);
+}
+
+ECPoint EllipticCurve::Multiply(const BigNum& lhs, const ECPoint& rhs) const
+{
+    return (lhs * rhs);
+}
+
+// Straus below MultiScalar::STRAUS_THRESHOLD terms, Pippenger above it, split across `threads` when large enough
+ECPoint EllipticCurve::MultiScalarMultiply(const std::vector<BigNum>& scalars, const std::vector<ECPoint>& points, size_t threads) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, scalars.size());
+
+    if (scalars.size() != points.size()) {
+        throw std::invalid_argument("EllipticCurve::MultiScalarMultiply: number of scalars and points mismatch");
+    }
+
+    std::vector<const BIGNUM*> rawScalars;
+    std::vector<const EC_POINT*> rawPoints;
+    rawScalars.reserve(scalars.size());
+    rawPoints.reserve(points.size());
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (points[i].GroupHandle() != group.get()) {
+            throw std::invalid_argument("EllipticCurve::MultiScalarMultiply: point is not on this curve");
+        }
+        rawScalars.push_back(scalars[i].RawPtr());
+        rawPoints.push_back(points[i].RawPtr());
+    }
+
+    EC_POINT* result = EC_POINT_new(group->RawPtr());
+    ECPoint point(group, result);
+
+    if (!MultiScalar::Multiply(group->RawPtr(), result, rawScalars, rawPoints, threads, group->Arithmetic().get())) {
+        throw std::runtime_error("EllipticCurve::MultiScalarMultiply: failed");
+    }
+
+    return point;
+}
+
+// result i is scalars[i] * G; jobs are spread over the shared pool, each worker using its own BN_CTX
+std::vector<ECPoint> EllipticCurve::BatchMultiply(const std::vector<BigNum>& scalars, size_t threads) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, scalars.size());
+
+    std::vector<ECPoint> results;
+    results.reserve(scalars.size());
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        results.emplace_back(group);
+    }
+
+    ParallelFor(scalars.size(), threads, [&](size_t begin, size_t end) {
+        auto ctx = BNContext::Get();
+        for (auto i = begin; i < end; ++i) {
+            if (!group->MultiplyGenerator(results[i].RawPtr(), scalars[i].RawPtr(), ctx)) {
+                throw std::runtime_error("EllipticCurve::BatchMultiply: failed");
+            }
+        }
+    });
+
+    return results;
+}
+
+// result i is scalars[i] * points[i], in input order
+std::vector<ECPoint> EllipticCurve::BatchMultiply(const std::vector<BigNum>& scalars, const std::vector<ECPoint>& points, size_t threads) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Multiply, scalars.size());
+
+    if (scalars.size() != points.size()) {
+        throw std::invalid_argument("EllipticCurve::BatchMultiply: number of scalars and points mismatch");
+    }
+
+    std::vector<ECPoint> results;
+    results.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (points[i].GroupHandle() != group.get()) {
+            throw std::invalid_argument("EllipticCurve::BatchMultiply: point is not on this curve");
+        }
+        results.emplace_back(group);
+    }
+
+    ParallelFor(points.size(), threads, [&](size_t begin, size_t end) {
+        auto ctx = BNContext::Get();
+        for (auto i = begin; i < end; ++i) {
+            if (1 != EC_POINT_mul(group->RawPtr(), results[i].RawPtr(), nullptr, points[i].RawPtr(), scalars[i].RawPtr(), ctx)) {
+                throw std::runtime_error("EllipticCurve::BatchMultiply: failed");
+            }
+        }
+    });
+
+    return results;
+}
+
+bool EllipticCurve::IsValidPoint(const ECPoint& point) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Validate, 1);
+
+    return 1 == EC_POINT_is_on_curve(group->RawPtr(), point.RawPtr(), BNContext::Get());
+}
+
+std::vector<uint64_t> EllipticCurve::ValidatePoints(const std::vector<ECPoint>& points, size_t threads) const
+{
+    return ValidatePoints(points.data(), points.size(), threads);
+}
+
+// bit i of the result is set when point i is a finite point of this curve. prime field points are
+// checked in Jacobian form as they are, so nothing is normalized on the way
+std::vector<uint64_t> EllipticCurve::ValidatePoints(const ECPoint* points, size_t count, size_t threads) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::Validate, count);
+
+    auto bitmap = std::vector<uint64_t>((count + 63) >> 6);
+    auto rawGroup = group->RawPtr();
+
+    // threads take whole words of the bitmap so that none of them share one
+    ParallelFor(bitmap.size(), threads, [&](size_t begin, size_t end) {
+        auto ctx = BNContext::Get();
+        auto last = std::min(end << 6, count);
+
+        for (auto i = begin << 6; i < last; ++i) {
+            const ECPoint& point = points[i];
+            if (point.GroupHandle() != group.get()) {
+                continue;
+            }
+
+            if (!EC_POINT_is_at_infinity(rawGroup, point.RawPtr()) && (1 == EC_POINT_is_on_curve(rawGroup, point.RawPtr(), ctx))) {
+                bitmap[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3f);
+            }
+        }
+    });
+
+    return bitmap;
+}
+
+// the same over length / EncodedLength encodings in the form of the first one, checked without
+// building any point: compressed ones by whether y exists, uncompressed ones by the curve equation
+std::vector<uint64_t> EllipticCurve::ValidateEncodings(const uint8_t* data, size_t length, size_t threads) const
+{
+    if (length == 0) {
+        return std::vector<uint64_t>();
+    }
+
+    auto compressed = (data[0] == 0x02) || (data[0] == 0x03);
+    auto stride = EncodedLength(compressed);
+    if ((length % stride) != 0) {
+        throw std::invalid_argument("EllipticCurve::ValidateEncodings: input length is not a multiple of the point length");
+    }
+
+    auto count = length / stride;
+    ECC_METRIC_SCOPE(*group, Operation::Validate, count);
+
+    auto bitmap = std::vector<uint64_t>((count + 63) >> 6);
+    auto& decompressor = group->Decompressor();
+
+    ParallelFor(bitmap.size(), threads, [&](size_t begin, size_t end) {
+        auto first = begin << 6;
+        auto last = std::min(end << 6, count);
+
+        decompressor.Validate(data + first * stride, last - first, compressed, &bitmap[begin], BNContext::Get());
+    });
+
+    return bitmap;
+}
+
+BigNum EllipticCurve::ConvertPB(const BigNum& nb) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, 1);
+    return Conversion().ConvertPB(nb);
+}
+
+BigNum EllipticCurve::ConvertNB(const BigNum& pb) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, 1);
+    return Conversion().ConvertNB(pb);
+}
+
+void EllipticCurve::ConvertPB(const uint8_t* nb, uint8_t* pb, size_t count) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, count);
+    Conversion().ConvertPB(nb, pb, count);
+}
+
+void EllipticCurve::ConvertNB(const uint8_t* pb, uint8_t* nb, size_t count) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, count);
+    Conversion().ConvertNB(pb, nb, count);
+}
+
+std::pair<BigNum, BigNum> EllipticCurve::ConvertNB(const ECPoint& point) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, 2);
+    auto& conversion = Conversion();
+    auto nbX = conversion.ConvertNB(point.XCoord());
+    auto nbY = conversion.ConvertNB(point.YCoord());
+
+    return std::make_pair(std::move(nbX), std::move(nbY));
+}
+
+ECPoint EllipticCurve::ConvertPB(const std::vector<uint8_t>& nbX, uint8_t ybit) const
+{
+    auto nbY = Conversion().ConvertPB(nbX);
+    return ConvertPB(nbX, nbY);
+}
+
+ECPoint EllipticCurve::ConvertPB(const BigNum& nbX, const BigNum& nbY) const
+{
+    ECC_METRIC_SCOPE(*group, Operation::ConvertBasis, 2);
+    auto& conversion = Conversion();
+    return ECPoint(group, conversion.ConvertPB(nbX), conversion.ConvertPB(nbY));
+}
+
+MetricsSnapshot EllipticCurve::Statistics() const
+{
+    auto metrics = group->Recorder();
+    return (metrics != nullptr) ? metrics->Snapshot() : Metrics::Disabled();
+}
+
+// built on first use, see ECBuilder; throws std::logic_error for prime field curves
+// and for binary field curves built without a normal basis root
+const BasisConversion& EllipticCurve::Conversion() const
+{
+    if (conversion == nullptr) {
+        throw std::logic_error("BasisConversion is not available for this curve");
+    }
+
+    return conversion->Get();
+}
@@ -1,83 +1,118 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#ifndef __ECC_ELLIPTIC_CURVE_H__
-#define __ECC_ELLIPTIC_CURVE_H__
-
-#include "BigNum.h"
-#include "ECGroup.h"
-#include "ECPoint.h"
-#include "BasisConversion.h"
-
-#include <vector>
-#include <memory>
-#include <utility>
-
-namespace ecc
-{
-    class EllipticCurve
-    {
-    public:
-        std::shared_ptr<ECGroup> group;
-        BasisConversion conversion;
-        BigNum order;
-
-    public:
-        EllipticCurve() = default;
-        ~EllipticCurve() = default;
-
-        EllipticCurve(const EllipticCurve& other);
-        EllipticCurve(const std::shared_ptr<ECGroup>& group, const BasisConversion& conversion, const BigNum& order);
-
-        EllipticCurve& operator=(const EllipticCurve& other);
-
-        BigNum RandomScalar();
-        BigNum Normalize(const BigNum& value) const;
-
-        ECPoint RandomPoint();
-        ECPoint Multiply(const BigNum& k);
-
-        ECPoint Point(const std::vector<uint8_t>& rawData);
-        ECPoint Point(const std::vector<uint8_t>& x, uint8_t ybit);
-        std::vector<uint8_t> Point2Vec(const ECPoint& point);
-        std::vector<uint8_t> Point2VecCompressed(const ECPoint& point);
-
-        BigNum Add(const BigNum& lhs, const BigNum& rhs) const;
-        ECPoint Add(const ECPoint& lhs, const ECPoint& rhs) const;
-
-        ECPoint Multiply(const BigNum& lhs, const ECPoint& rhs) const;
-
-        BigNum ConvertNB(const BigNum& pb) const;
-        BigNum ConvertPB(const BigNum& nb) const;
-
-        std::pair<BigNum, BigNum> ConvertNB(const ECPoint& point) const;
-
-        ECPoint ConvertPB(const std::vector<uint8_t>& x, uint8_t ybit) const;
-        ECPoint ConvertPB(const BigNum& x, const BigNum& y) const;
-
-        bool IsValidPoint(const ECPoint& point) const;
-    };
-}
-
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_ELLIPTIC_CURVE_H__
+#define __ECC_ELLIPTIC_CURVE_H__
+
+#include "BigNum.h"
+#include "ECGroup.h"
+#include "ECPoint.h"
+#include "BasisConversion.h"
+#include "LazyBasisConversion.h"
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+namespace ecc
+{
+    class EllipticCurve
+    {
+    public:
+        std::shared_ptr<ECGroup> group;
+        std::shared_ptr<LazyBasisConversion> conversion;
+        BigNum order;
+
+    public:
+        EllipticCurve() = default;
+        ~EllipticCurve() = default;
+
+        EllipticCurve(const EllipticCurve& other);
+        EllipticCurve(EllipticCurve&& other) = default;
+        EllipticCurve(const std::shared_ptr<ECGroup>& group, const BasisConversion& conversion, const BigNum& order);
+        EllipticCurve(const std::shared_ptr<ECGroup>& group, const std::shared_ptr<LazyBasisConversion>& conversion, const BigNum& order);
+
+        EllipticCurve& operator=(const EllipticCurve& other);
+        EllipticCurve& operator=(EllipticCurve&& other) = default;
+
+        BigNum RandomScalar() const;
+        BigNum Normalize(const BigNum& value) const;
+
+        ECPoint RandomPoint() const;
+        ECPoint Multiply(const BigNum& k) const;
+
+        // k * G through the precomputed comb, faster but with timing that depends on k. only for scalars
+        // that are not secret, such as the u1 = e / s of signature verification; keys go through Multiply
+        ECPoint MultiplyPublic(const BigNum& k) const;
+
+        ECPoint Point(const std::vector<uint8_t>& rawData) const;
+        ECPoint Point(const std::vector<uint8_t>& x, uint8_t ybit) const;
+        std::vector<uint8_t> Point2Vec(const ECPoint& point) const;
+        std::vector<uint8_t> Point2VecCompressed(const ECPoint& point) const;
+
+        void MakeAffine(std::vector<ECPoint>& points) const;
+        void MakeAffine(ECPoint* points, size_t count) const;
+
+        size_t EncodedLength(bool compressed) const;
+        void Encode(std::vector<ECPoint>& points, uint8_t* out, size_t length, bool compressed) const;
+        void Encode(ECPoint* points, size_t count, uint8_t* out, size_t length, bool compressed) const;
+        void Decode(const uint8_t* data, size_t length, std::vector<ECPoint>& points, size_t threads = 1) const;
+
+        BigNum Add(const BigNum& lhs, const BigNum& rhs) const;
+        ECPoint Add(const ECPoint& lhs, const ECPoint& rhs) const;
+
+        ECPoint Multiply(const BigNum& lhs, const ECPoint& rhs) const;
+        ECPoint MultiScalarMultiply(const std::vector<BigNum>& scalars, const std::vector<ECPoint>& points, size_t threads = 1) const;
+
+        std::vector<ECPoint> BatchMultiply(const std::vector<BigNum>& scalars, size_t threads = 1) const;
+        std::vector<ECPoint> BatchMultiply(const std::vector<BigNum>& scalars, const std::vector<ECPoint>& points, size_t threads = 1) const;
+
+        BigNum ConvertNB(const BigNum& pb) const;
+        BigNum ConvertPB(const BigNum& nb) const;
+
+        void ConvertNB(const uint8_t* pb, uint8_t* nb, size_t count) const;
+        void ConvertPB(const uint8_t* nb, uint8_t* pb, size_t count) const;
+
+        std::pair<BigNum, BigNum> ConvertNB(const ECPoint& point) const;
+
+        ECPoint ConvertPB(const std::vector<uint8_t>& x, uint8_t ybit) const;
+        ECPoint ConvertPB(const BigNum& x, const BigNum& y) const;
+
+        bool IsValidPoint(const ECPoint& point) const;
+        std::vector<uint64_t> ValidatePoints(const std::vector<ECPoint>& points, size_t threads = 1) const;
+        std::vector<uint64_t> ValidatePoints(const ECPoint* points, size_t count, size_t threads = 1) const;
+        std::vector<uint64_t> ValidateEncodings(const uint8_t* data, size_t length, size_t threads = 1) const;
+
+        // operation counts and latencies of this curve and its points; enabled is false without ECC_ENABLE_METRICS.
+        // contexts is the exception: BN_CTX are created once per thread and shared by every curve, so it
+        // counts the contexts of the whole process and is the same in the snapshots of all curves
+        MetricsSnapshot Statistics() const;
+
+    private:
+        const BasisConversion& Conversion() const;
+        void CompressedBits(const std::vector<BIGNUM*>& xs, const std::vector<BIGNUM*>& ys, uint8_t* bits, BN_CTX* ctx) const;
+    };
+}
+
 #endif
\ No newline at end of file
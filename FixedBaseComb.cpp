@@ -0,0 +1,174 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FixedBaseComb.h"
+#include "BNContext.h"
+#include "ECAffine.h"
+#include <stdexcept>
+#include <string>
+#include <openssl/err.h>
+#include <openssl/obj_mac.h>
+
+using namespace ecc;
+
+static void handleErrors(const std::string& msg)
+{
+    auto err = ERR_get_error();
+    throw std::runtime_error(msg + ": " + ERR_reason_error_string(err));
+}
+
+FixedBaseComb::FixedBaseComb(const EC_GROUP* group, const std::shared_ptr<const LopezDahab>& arithmetic, size_t teeth) : teeth(teeth), table(size_t(1) << teeth, nullptr)
+{
+    binaryField = (EC_GROUP_get_field_type(group) == NID_X9_62_characteristic_two_field);
+    if (binaryField && (arithmetic == nullptr)) {
+        throw std::invalid_argument("FixedBaseComb: binary field groups need Lopez-Dahab arithmetic");
+    }
+
+    auto ctx = BNContext::Get();
+
+    // the destructor does not run for a constructor that throws
+    auto fail = [this](const std::string& msg) {
+        for (auto point : table) {
+            EC_POINT_free(point);
+        }
+        handleErrors(msg);
+    };
+
+    auto bits = BN_num_bits(EC_GROUP_get0_order(group));
+    spacing = (bits + teeth - 1) / teeth;
+
+    // table[2^i] = 2^(i * spacing) * G
+    table[1] = EC_POINT_dup(EC_GROUP_get0_generator(group), group);
+    for (size_t i = 1; i < teeth; ++i) {
+        auto point = EC_POINT_dup(table[size_t(1) << (i - 1)], group);
+        table[size_t(1) << i] = point;
+        for (size_t j = 0; j < spacing; ++j) {
+            if (1 != EC_POINT_dbl(group, point, point, ctx)) {
+                fail("EC_POINT_dbl");
+            }
+        }
+    }
+
+    // table[j] = table[j - top] + table[top], where top is the highest bit of j
+    size_t top = 1;
+    for (size_t j = 3; j < table.size(); ++j) {
+        if ((j & (j - 1)) == 0) {
+            top = j;
+            continue;
+        }
+
+        table[j] = EC_POINT_new(group);
+        if (1 != EC_POINT_add(group, table[j], table[j - top], table[top], ctx)) {
+            fail("EC_POINT_add");
+        }
+    }
+
+    if (!MakeAffine(group, table.size() - 1, table.data() + 1, ctx)) {
+        fail("EC_POINTs_make_affine");
+    }
+
+    if (binaryField) {
+        this->arithmetic = arithmetic;
+        binaryTable = std::vector<LDPoint>(table.size());
+        for (size_t j = 1; j < table.size(); ++j) {
+            if (!arithmetic->Import(binaryTable[j], group, table[j], ctx)) {
+                fail("EC_POINT_get_affine_coordinates");
+            }
+        }
+    }
+}
+
+FixedBaseComb::~FixedBaseComb()
+{
+    for (auto point : table) {
+        EC_POINT_free(point);
+    }
+}
+
+bool FixedBaseComb::Multiply(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const
+{
+    BN_CTX_start(ctx);
+
+    // the generator has the group order, so reducing keeps every scalar within the table
+    auto scalar = BN_CTX_get(ctx);
+    auto success = (scalar != NULL) && (1 == BN_nnmod(scalar, k, EC_GROUP_get0_order(group), ctx));
+
+    if (success) {
+        if (binaryField) {
+            success = MultiplyGF2m(group, result, scalar, ctx);
+        } else {
+            success = MultiplyGFp(group, result, scalar, ctx);
+        }
+    }
+
+    BN_CTX_end(ctx);
+    return success;
+}
+
+size_t FixedBaseComb::Index(const BIGNUM* k, size_t column) const
+{
+    size_t idx = 0;
+    for (size_t i = 0; i < teeth; ++i) {
+        idx |= static_cast<size_t>(BN_is_bit_set(k, i * spacing + column)) << i;
+    }
+
+    return idx;
+}
+
+bool FixedBaseComb::MultiplyGFp(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const
+{
+    if (1 != EC_POINT_set_to_infinity(group, result)) {
+        return false;
+    }
+
+    for (auto column = spacing; column-- > 0;) {
+        if (1 != EC_POINT_dbl(group, result, result, ctx)) {
+            return false;
+        }
+
+        auto idx = Index(k, column);
+        if ((idx != 0) && (1 != EC_POINT_add(group, result, result, table[idx], ctx))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FixedBaseComb::MultiplyGF2m(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const
+{
+    LDPoint point;
+    arithmetic->SetInfinity(point);
+
+    for (auto column = spacing; column-- > 0;) {
+        arithmetic->Double(point, ctx);
+
+        auto idx = Index(k, column);
+        if (idx != 0) {
+            arithmetic->Add(point, binaryTable[idx], ctx);
+        }
+    }
+
+    return arithmetic->Export(group, result, point, ctx);
+}
\ No newline at end of file
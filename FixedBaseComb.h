@@ -0,0 +1,76 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_FIXED_BASE_COMB_H__
+#define __ECC_FIXED_BASE_COMB_H__
+
+#include "LopezDahab.h"
+
+#include <openssl/ec.h>
+#include <openssl/bn.h>
+#include <vector>
+#include <memory>
+
+namespace ecc
+{
+    // FixedBaseComb : precomputed comb table for multiplying the generator
+    //
+    // the scalar is split into `teeth` rows of `spacing` bits, and entry j of the table holds
+    // sum(bit_i(j) * 2^(i * spacing)) * G in affine form, so a multiplication costs `spacing`
+    // doublings and at most `spacing` mixed additions.
+    // binary fields run the loop in Lopez-Dahab projective coordinates to avoid a field inversion per step.
+    // the table lookup and the skipped addition for a zero column depend on the scalar bits, so the loop is
+    // not constant time and must only see public scalars. secret scalars go through EC_POINT_mul.
+    class FixedBaseComb
+    {
+    private:
+        bool binaryField;
+        size_t teeth;
+        size_t spacing;
+
+        std::vector<EC_POINT*> table;
+
+        // binary field only
+        std::shared_ptr<const LopezDahab> arithmetic;
+        std::vector<LDPoint> binaryTable;
+
+    public:
+        // arithmetic is required for binary field groups and ignored for prime ones
+        FixedBaseComb(const EC_GROUP* group, const std::shared_ptr<const LopezDahab>& arithmetic, size_t teeth = 8);
+        FixedBaseComb(const FixedBaseComb& other) = delete;
+        ~FixedBaseComb();
+
+        FixedBaseComb& operator=(const FixedBaseComb& other) = delete;
+
+        bool Multiply(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const;
+
+    private:
+        size_t Index(const BIGNUM* k, size_t column) const;
+
+        bool MultiplyGFp(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const;
+        bool MultiplyGF2m(const EC_GROUP* group, EC_POINT* result, const BIGNUM* k, BN_CTX* ctx) const;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,180 +1,486 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "GF2Matrix.h"
-#include <stdexcept>
-#include <sstream>
-#include <iomanip>
-
-using namespace ecc;
-
-GF2Matrix::GF2Matrix(const GF2Matrix& other) : elements(other.elements)
-{}
-
-size_t GF2Matrix::Rows() const
-{
-    return elements.size();
-}
-
-size_t GF2Matrix::Cols() const
-{
-    return elements[0].size();
-}
-
-void GF2Matrix::AddRow(const std::vector<uint32_t>& row)
-{
-    elements.push_back(row);
-}
-
-const std::vector<uint32_t>& GF2Matrix::operator[](size_t idx) const
-{
-    return elements[idx];
-}
-
-const std::string GF2Matrix::ToString() const
-{
-    std::ostringstream oss;
-
-    for (auto i = 0; i < Rows(); ++i) {
-        for (auto j = 0; j < Cols(); ++j) {
-            oss << std::hex << std::setfill('0') << std::setw(8) << +elements[i][j] << " ";
-        }
-        oss << std::endl;
-    }
-
-    return oss.str();
-}
-
-GF2Matrix GF2Matrix::Invert() const
-{
-    auto tmpElements = std::vector<std::vector<uint32_t>>(elements);
-    auto invElements = UnitElements();
-
-    for (auto i = 0; i < Rows(); ++i) {
-        int q = i >> 5;
-        int bitMask = 1 << (i & 0x1f);
-
-        if ((tmpElements[i][q] & bitMask) == 0) {
-            bool foundNonZero = false;
-
-            for (int j = i + 1; j < Rows(); ++j) {
-                if ((tmpElements[j][q] & bitMask) != 0) {
-                    foundNonZero = true;
-                    SwapRows(tmpElements, i, j);
-                    SwapRows(invElements, i, j);
-                    j = Rows();
-                    continue;
-                }
-            }
-
-            if (!foundNonZero) {
-                throw std::logic_error("The matrix is not invertible.");
-            }
-        }
-
-        for (int j = Rows() - 1; j >= 0; --j) {
-            if ((j != i) && ((tmpElements[j][q] & bitMask) != 0)) {
-                AddToRow(tmpElements[j], tmpElements[i], q);
-                AddToRow(invElements[j], invElements[i], 0);
-            }
-        }
-    }
-
-    GF2Matrix result;
-    for (auto row : invElements) {
-        result.AddRow(row);
-    }
-
-    return result;
-}
-
-std::vector<std::vector<uint32_t>> GF2Matrix::UnitElements() const
-{
-    auto unitElements = std::vector<std::vector<uint32_t>>();
-    for (auto row : elements) {
-        unitElements.push_back(std::vector<uint32_t>(Cols()));
-    }
-    for (int i = Rows() - 1; i >= 0; --i) {
-        int q = i >> 5;
-        int r = i & 0x1f;
-        unitElements[i][q] = 1 << r;
-    }
-
-    return unitElements;
-}
-
-void GF2Matrix::SwapRows(std::vector<std::vector<uint32_t>>& elements, size_t from, size_t to) const
-{
-    elements[from].swap(elements[to]);
-}
-
-void GF2Matrix::AddToRow(std::vector<uint32_t>& dst, const std::vector<uint32_t>& src, size_t startIdx) const
-{
-    for (int i = dst.size() - 1; i >= static_cast<int>(startIdx); --i) {
-        dst[i] = src[i] ^ dst[i];
-    }
-}
-
-GF2Polynomial ecc::operator*(const GF2Polynomial& lhs, const GF2Matrix& rhs)
-{
-    if (lhs.Length() != rhs.Rows()) {
-        throw std::invalid_argument("length mismatch");
-    }
-
-    auto res = std::vector<uint32_t>(rhs.Cols(), 0);
-
-    auto q = rhs.Rows() >> 5;
-    auto r = 1 << (rhs.Rows() & 0x1f);
-
-    size_t row = 0;
-    for (auto i = 0; i < q; ++i) {
-        uint32_t bitmask = 1;
-        do {
-            auto b = lhs[i] & bitmask;
-            if (b != 0) {
-                for (auto col = 0; col < rhs.Cols(); ++col) {
-                    res[col] ^= rhs[row][col];
-                }
-            }
-
-            row += 1;
-            bitmask <<= 1;
-        } while (bitmask != 0);
-    }
-
-    uint32_t bitmask = 1;
-    while (bitmask != r) {
-        auto b = lhs[q] & bitmask;
-        if (b != 0) {
-            for (auto col = 0; col < rhs.Cols(); ++col) {
-                res[col] ^= rhs[row][col];
-            }
-        }
-
-        row += 1;
-        bitmask <<= 1;
-    }
-
-    return GF2Polynomial(lhs.Length(), res);
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "GF2Matrix.h"
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+#include <algorithm>
+
+using namespace ecc;
+
+const size_t GF2Matrix::CHUNK_BITS;
+const size_t GF2Matrix::INVERT_BLOCK_BITS;
+const size_t GF2Matrix::MULTIPLY_BLOCK;
+
+static inline void XorWords(uint64_t* dst, const uint64_t* src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] ^= src[i];
+    }
+}
+
+GF2Matrix::GF2Matrix() : rows(0), cols(0), stride(0), data(nullptr), tableData(nullptr)
+{}
+
+GF2Matrix::GF2Matrix(size_t rows, size_t cols) : rows(rows), cols(cols), stride(RowStride(cols)), elements(rows * stride, 0), tableData(nullptr)
+{
+    Bind();
+}
+
+// views share their storage, owned matrices are deep copied
+GF2Matrix::GF2Matrix(const GF2Matrix& other) : rows(other.rows), cols(other.cols), stride(other.stride), elements(other.elements), tables(other.tables), data(other.data), tableData(other.tableData), owner(other.owner)
+{
+    Bind();
+}
+
+GF2Matrix::GF2Matrix(GF2Matrix&& other) noexcept : rows(other.rows), cols(other.cols), stride(other.stride), elements(std::move(other.elements)), tables(std::move(other.tables)), data(other.data), tableData(other.tableData), owner(std::move(other.owner))
+{
+    Bind();
+    other.rows = 0;
+    other.Bind();
+}
+
+GF2Matrix& GF2Matrix::operator=(const GF2Matrix& other)
+{
+    rows = other.rows;
+    cols = other.cols;
+    stride = other.stride;
+    elements = other.elements;
+    tables = other.tables;
+    data = other.data;
+    tableData = other.tableData;
+    owner = other.owner;
+    Bind();
+    return *this;
+}
+
+GF2Matrix& GF2Matrix::operator=(GF2Matrix&& other) noexcept
+{
+    rows = other.rows;
+    cols = other.cols;
+    stride = other.stride;
+    elements = std::move(other.elements);
+    tables = std::move(other.tables);
+    data = other.data;
+    tableData = other.tableData;
+    owner = std::move(other.owner);
+    Bind();
+    other.rows = 0;
+    other.Bind();
+    return *this;
+}
+
+// data holds rows * RowStride(cols) words, tables holds TableLength(rows, cols) words or is null;
+// both must start on a 64-byte boundary and stay valid for as long as owner is alive
+GF2Matrix GF2Matrix::View(size_t rows, size_t cols, const uint64_t* data, const uint64_t* tables, const std::shared_ptr<const void>& owner)
+{
+    GF2Matrix view;
+    view.rows = rows;
+    view.cols = cols;
+    view.stride = RowStride(cols);
+    view.data = data;
+    view.tableData = tables;
+    view.owner = owner;
+
+    return view;
+}
+
+// 64-bit words per row, rounded up to a whole number of 64-byte lines
+size_t GF2Matrix::RowStride(size_t cols)
+{
+    auto words = (cols + 63) >> 6;
+    return (words + 7) & ~static_cast<size_t>(7);
+}
+
+size_t GF2Matrix::TableLength(size_t rows, size_t cols)
+{
+    auto chunks = (rows + CHUNK_BITS - 1) / CHUNK_BITS;
+    return (chunks << CHUNK_BITS) * RowStride(cols);
+}
+
+size_t GF2Matrix::Rows() const
+{
+    return rows;
+}
+
+size_t GF2Matrix::Cols() const
+{
+    return cols;
+}
+
+size_t GF2Matrix::Stride() const
+{
+    return stride;
+}
+
+bool GF2Matrix::IsView() const
+{
+    return owner != nullptr;
+}
+
+const uint64_t* GF2Matrix::Data() const
+{
+    return data;
+}
+
+// null until Precompute() has run
+const uint64_t* GF2Matrix::TableData() const
+{
+    return tableData;
+}
+
+// the first row fixes the width of the matrix at 32 bits per block
+void GF2Matrix::AddRow(const std::vector<uint32_t>& row)
+{
+    Detach();
+
+    if (rows == 0) {
+        cols = row.size() << 5;
+        stride = RowStride(cols);
+    }
+
+    if ((row.size() << 5) > ((cols + 31) & ~static_cast<size_t>(31))) {
+        throw std::invalid_argument("GF2Matrix::AddRow: row is wider than the matrix");
+    }
+
+    elements.resize(elements.size() + stride, 0);
+    rows += 1;
+    tables.clear();
+    Bind();
+
+    auto dst = Row(rows - 1);
+    for (size_t i = 0; i < row.size(); ++i) {
+        dst[i >> 1] |= static_cast<uint64_t>(row[i]) << ((i & 0x1) << 5);
+    }
+}
+
+void GF2Matrix::SetRow(size_t idx, const std::vector<uint64_t>& row)
+{
+    if (idx >= rows) {
+        throw std::out_of_range("GF2Matrix::SetRow: row index is out of range");
+    }
+
+    if (row.size() > stride) {
+        throw std::invalid_argument("GF2Matrix::SetRow: row is wider than the matrix");
+    }
+
+    Detach();
+    tables.clear();
+    Bind();
+
+    auto dst = Row(idx);
+    std::fill(dst, dst + stride, 0);
+    std::copy(row.begin(), row.end(), dst);
+
+    if ((cols & 0x3f) != 0) {
+        dst[cols >> 6] &= (static_cast<uint64_t>(1) << (cols & 0x3f)) - 1;
+    }
+}
+
+const uint64_t* GF2Matrix::operator[](size_t idx) const
+{
+    return data + idx * stride;
+}
+
+// Four-Russians tables: one 2^CHUNK_BITS entry table per chunk of rows, each entry built
+// from the entry with its lowest bit cleared plus one row
+void GF2Matrix::Precompute()
+{
+    const size_t entries = static_cast<size_t>(1) << CHUNK_BITS;
+    auto chunks = (rows + CHUNK_BITS - 1) / CHUNK_BITS;
+
+    Detach();
+    tables.assign(TableLength(rows, cols), 0);
+    Bind();
+
+    for (size_t c = 0; c < chunks; ++c) {
+        auto table = &tables[c * entries * stride];
+
+        for (size_t u = 1; u < entries; ++u) {
+            size_t low = 0;
+            while (((u >> low) & 0x1) == 0) {
+                low += 1;
+            }
+
+            auto entry = table + u * stride;
+            std::copy(table + (u & (u - 1)) * stride, table + (u & (u - 1)) * stride + stride, entry);
+
+            auto row = c * CHUNK_BITS + low;
+            if (row < rows) {
+                XorWords(entry, (*this)[row], stride);
+            }
+        }
+    }
+}
+
+bool GF2Matrix::HasTables() const
+{
+    return tableData != nullptr;
+}
+
+GF2Polynomial GF2Matrix::Multiply(const GF2Polynomial& vec) const
+{
+    if (vec.Length() != rows) {
+        throw std::invalid_argument("length mismatch");
+    }
+
+    auto words = vec.Words();
+    auto result = std::vector<uint64_t>((cols + 63) >> 6, 0);
+    Multiply(words.data(), result.data(), 1);
+
+    return GF2Polynomial::FromWords(cols, result);
+}
+
+// vectors holds count inputs of (Rows() + 63) / 64 words, results receives count outputs of
+// (Cols() + 63) / 64 words. the table of one chunk is applied to a whole block of inputs before
+// moving on to the next, so it stays in cache while the block streams through it.
+void GF2Matrix::Multiply(const uint64_t* vectors, uint64_t* results, size_t count) const
+{
+    const size_t inWords = (rows + 63) >> 6;
+    const size_t outWords = (cols + 63) >> 6;
+    const size_t entries = static_cast<size_t>(1) << CHUNK_BITS;
+    const uint64_t mask = entries - 1;
+    auto chunks = (rows + CHUNK_BITS - 1) / CHUNK_BITS;
+
+    auto acc = AlignedWords(std::min(count, MULTIPLY_BLOCK) * stride);
+
+    for (size_t first = 0; first < count; first += MULTIPLY_BLOCK) {
+        auto n = std::min(MULTIPLY_BLOCK, count - first);
+        auto input = vectors + first * inWords;
+        std::fill(acc.begin(), acc.end(), 0);
+
+        if (HasTables()) {
+            for (size_t c = 0; c < chunks; ++c) {
+                auto table = tableData + c * entries * stride;
+                auto bit = c * CHUNK_BITS;
+
+                for (size_t e = 0; e < n; ++e) {
+                    auto u = (input[e * inWords + (bit >> 6)] >> (bit & 0x3f)) & mask;
+                    if (u != 0) {
+                        XorWords(&acc[e * stride], table + u * stride, outWords);
+                    }
+                }
+            }
+        } else {
+            for (size_t e = 0; e < n; ++e) {
+                for (size_t i = 0; i < rows; ++i) {
+                    if (((input[e * inWords + (i >> 6)] >> (i & 0x3f)) & 0x1) != 0) {
+                        XorWords(&acc[e * stride], (*this)[i], outWords);
+                    }
+                }
+            }
+        }
+
+        for (size_t e = 0; e < n; ++e) {
+            std::copy(&acc[e * stride], &acc[e * stride] + outWords, results + (first + e) * outWords);
+        }
+    }
+}
+
+const std::string GF2Matrix::ToString() const
+{
+    std::ostringstream oss;
+
+    auto words = (cols + 63) >> 6;
+    for (size_t i = 0; i < rows; ++i) {
+        auto row = (*this)[i];
+        for (size_t j = 0; j < words; ++j) {
+            oss << std::hex << std::setfill('0') << std::setw(16) << row[j] << " ";
+        }
+        oss << std::endl;
+    }
+
+    return oss.str();
+}
+
+GF2Matrix GF2Matrix::Invert() const
+{
+    GF2Matrix inverse;
+    if (Invert(inverse) != rows) {
+        throw std::logic_error("The matrix is not invertible.");
+    }
+
+    return inverse;
+}
+
+static inline uint64_t GetBit(const uint64_t* row, size_t col)
+{
+    return (row[col >> 6] >> (col & 0x3f)) & 0x1;
+}
+
+// Gauss-Jordan on [A | I] in the Method of Four Russians style: each pass finds pivots for
+// INVERT_BLOCK_BITS columns, tabulates every combination of those pivot rows, and then clears
+// the block from all remaining rows with one table lookup per row.
+// returns the rank of the leading rows x rows block; inverse is only filled when it is full.
+size_t GF2Matrix::Invert(GF2Matrix& inverse) const
+{
+    static_assert((64 % INVERT_BLOCK_BITS) == 0, "column blocks must not straddle a word");
+
+    const size_t entries = static_cast<size_t>(1) << INVERT_BLOCK_BITS;
+
+    // the working rows are packed without the cache line padding, A in the first half and I in the second
+    const size_t half = (cols + 63) >> 6;
+    const size_t width = half << 1;
+
+    auto aug = AlignedWords(rows * width, 0);
+    for (size_t i = 0; i < rows; ++i) {
+        std::copy((*this)[i], (*this)[i] + half, &aug[i * width]);
+        aug[i * width + half + (i >> 6)] = static_cast<uint64_t>(1) << (i & 0x3f);
+    }
+
+    auto row = [&](size_t idx) { return &aug[idx * width]; };
+    auto table = AlignedWords(entries * width, 0);
+
+    size_t rank = 0;
+    size_t firstFree = rows;
+    std::vector<size_t> pivots;
+    pivots.reserve(INVERT_BLOCK_BITS);
+
+    for (size_t c = 0; c < rows; c += INVERT_BLOCK_BITS) {
+        auto end = std::min(c + INVERT_BLOCK_BITS, rows);
+        auto start = std::min(c, firstFree) >> 6;
+        pivots.clear();
+
+        // pivot search: candidate rows are first reduced by the pivots already found in this block
+        for (auto col = c; col < end; ++col) {
+            auto found = false;
+
+            for (auto i = rank + pivots.size(); i < rows; ++i) {
+                auto candidate = row(i);
+                for (size_t t = 0; t < pivots.size(); ++t) {
+                    if (GetBit(candidate, pivots[t]) != 0) {
+                        XorWords(candidate + start, row(rank + t) + start, width - start);
+                    }
+                }
+
+                if (GetBit(candidate, col) != 0) {
+                    auto target = rank + pivots.size();
+                    std::swap_ranges(candidate, candidate + width, row(target));
+
+                    for (size_t t = 0; t < pivots.size(); ++t) {
+                        if (GetBit(row(rank + t), col) != 0) {
+                            XorWords(row(rank + t) + start, row(target) + start, width - start);
+                        }
+                    }
+
+                    pivots.push_back(col);
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found && (firstFree == rows)) {
+                firstFree = col;
+            }
+        }
+
+        if (pivots.empty()) {
+            continue;
+        }
+
+        // table[u] = xor of the pivot rows selected by the bits of u
+        auto count = static_cast<size_t>(1) << pivots.size();
+        for (size_t u = 1; u < count; ++u) {
+            size_t low = 0;
+            while (((u >> low) & 0x1) == 0) {
+                low += 1;
+            }
+
+            auto entry = &table[u * width];
+            auto prev = &table[(u & (u - 1)) * width];
+            std::copy(prev + start, prev + width, entry + start);
+            XorWords(entry + start, row(rank + low) + start, width - start);
+        }
+
+        for (size_t i = 0; i < rows; ++i) {
+            if ((i >= rank) && (i < rank + pivots.size())) {
+                continue;
+            }
+
+            auto target = row(i);
+            size_t u = 0;
+            if (pivots.size() == end - c) {
+                // a full block never straddles a word, so its bits are read in one go
+                u = (target[c >> 6] >> (c & 0x3f)) & (count - 1);
+            } else {
+                for (size_t t = 0; t < pivots.size(); ++t) {
+                    u |= static_cast<size_t>(GetBit(target, pivots[t])) << t;
+                }
+            }
+
+            if (u != 0) {
+                XorWords(target + start, &table[u * width] + start, width - start);
+            }
+        }
+
+        rank += pivots.size();
+    }
+
+    if (rank == rows) {
+        inverse = GF2Matrix(rows, cols);
+        for (size_t i = 0; i < rows; ++i) {
+            std::copy(row(i) + half, row(i) + width, inverse.Row(i));
+        }
+    }
+
+    return rank;
+}
+
+uint64_t* GF2Matrix::Row(size_t idx)
+{
+    return &elements[idx * stride];
+}
+
+// points data and tableData at the owned words unless this is a view
+void GF2Matrix::Bind()
+{
+    if (owner != nullptr) {
+        return;
+    }
+
+    data = elements.empty() ? nullptr : elements.data();
+    tableData = tables.empty() ? nullptr : tables.data();
+}
+
+void GF2Matrix::Detach()
+{
+    if (owner == nullptr) {
+        return;
+    }
+
+    elements.assign(data, data + rows * stride);
+    if (tableData != nullptr) {
+        tables.assign(tableData, tableData + TableLength(rows, cols));
+    }
+
+    owner.reset();
+    Bind();
+}
+
+GF2Polynomial ecc::operator*(const GF2Polynomial& lhs, const GF2Matrix& rhs)
+{
+    return rhs.Multiply(lhs);
 }
\ No newline at end of file
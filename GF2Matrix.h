@@ -1,63 +1,115 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#ifndef __ECC_GF2_MATRIX_H__
-#define __ECC_GF2_MATRIX_H__
-
-#include "BigNum.h"
-#include "GF2Polynomial.h"
-
-namespace ecc
-{
-    class GF2Matrix
-    {
-    private:
-        std::vector<std::vector<uint32_t>> elements;
-
-    public:
-        GF2Matrix() = default;
-        ~GF2Matrix() = default;
-
-        GF2Matrix(const GF2Matrix& other);
-
-        size_t Rows() const;
-        size_t Cols() const;
-
-        void AddRow(const std::vector<uint32_t>& row);
-        const std::vector<uint32_t>& operator[](size_t idx) const;
-
-        GF2Matrix Invert() const;
-
-        const std::string ToString() const;
-
-    private:
-        std::vector<std::vector<uint32_t>> UnitElements() const;
-        void SwapRows(std::vector<std::vector<uint32_t>>& elements, size_t from, size_t to) const;
-        void AddToRow(std::vector<uint32_t>& dst, const std::vector<uint32_t>& src, size_t startIdx) const;
-    };
-
-    GF2Polynomial operator*(const GF2Polynomial& lhs, const GF2Matrix& rhs);
-}
-
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_GF2_MATRIX_H__
+#define __ECC_GF2_MATRIX_H__
+
+#include "BigNum.h"
+#include "GF2Polynomial.h"
+#include "AlignedAllocator.h"
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace ecc
+{
+    typedef std::vector<uint64_t, AlignedAllocator<uint64_t>> AlignedWords;
+
+    // row-major bit matrix in one contiguous block, each row padded to whole cache lines.
+    // the words either live in the matrix itself or, for a view, in read-only storage kept
+    // alive by owner (e.g. a mapped file); a view copies its words out before any change.
+    class GF2Matrix
+    {
+    public:
+        // rows are grouped into chunks of this many bits for the Four-Russians tables
+        static const size_t CHUNK_BITS = 8;
+
+        // columns eliminated per pass of the blocked (M4RI) inverse
+        static const size_t INVERT_BLOCK_BITS = 8;
+
+        // inputs pushed through one chunk table at a time by the batch Multiply
+        static const size_t MULTIPLY_BLOCK = 64;
+
+    private:
+        size_t rows;
+        size_t cols;
+        size_t stride;
+        AlignedWords elements;
+
+        // tables[(chunk << CHUNK_BITS) + u] is the xor of the rows selected by the bits of u
+        AlignedWords tables;
+
+        const uint64_t* data;
+        const uint64_t* tableData;
+        std::shared_ptr<const void> owner;
+
+    public:
+        GF2Matrix();
+        GF2Matrix(size_t rows, size_t cols);
+        ~GF2Matrix() = default;
+
+        GF2Matrix(const GF2Matrix& other);
+        GF2Matrix(GF2Matrix&& other) noexcept;
+
+        GF2Matrix& operator=(const GF2Matrix& other);
+        GF2Matrix& operator=(GF2Matrix&& other) noexcept;
+
+        static GF2Matrix View(size_t rows, size_t cols, const uint64_t* data, const uint64_t* tables, const std::shared_ptr<const void>& owner);
+
+        static size_t RowStride(size_t cols);
+        static size_t TableLength(size_t rows, size_t cols);
+
+        size_t Rows() const;
+        size_t Cols() const;
+        size_t Stride() const;
+        bool IsView() const;
+
+        const uint64_t* Data() const;
+        const uint64_t* TableData() const;
+
+        void AddRow(const std::vector<uint32_t>& row);
+        void SetRow(size_t idx, const std::vector<uint64_t>& row);
+        const uint64_t* operator[](size_t idx) const;
+
+        void Precompute();
+        bool HasTables() const;
+
+        GF2Polynomial Multiply(const GF2Polynomial& vec) const;
+        void Multiply(const uint64_t* vectors, uint64_t* results, size_t count) const;
+        GF2Matrix Invert() const;
+        size_t Invert(GF2Matrix& inverse) const;
+
+        const std::string ToString() const;
+
+    private:
+        uint64_t* Row(size_t idx);
+        void Bind();
+        void Detach();
+    };
+
+    GF2Polynomial operator*(const GF2Polynomial& lhs, const GF2Matrix& rhs);
+}
+
 #endif
\ No newline at end of file
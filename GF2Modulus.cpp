@@ -0,0 +1,225 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "GF2Modulus.h"
+#include "ScratchArena.h"
+
+#include <stdexcept>
+
+using namespace ecc;
+
+// x^(64 * i) * t folded by x^m = x^k, i.e. t moved down by (m - k) bits
+static inline void FoldWord(uint64_t* r, size_t i, uint64_t t, size_t m, size_t k)
+{
+    auto distance = m - k;
+    auto n = distance >> 6;
+    auto shift = distance & 0x3f;
+
+    r[i - n] ^= t >> shift;
+    if (shift != 0) {
+        r[i - n - 1] ^= t << (64 - shift);
+    }
+}
+
+// adds t * x^k for a t sitting just above the degree
+static inline void FoldTop(uint64_t* r, uint64_t t, size_t k)
+{
+    auto n = k >> 6;
+    auto shift = k & 0x3f;
+
+    r[n] ^= t << shift;
+    if (shift != 0) {
+        auto carry = t >> (64 - shift);
+        if (carry != 0) {
+            r[n + 1] ^= carry;
+        }
+    }
+}
+
+// every fold of a word lands strictly below it, so one pass from the top is enough
+template <size_t N>
+static void ReduceSparse(uint64_t* r, size_t top, size_t m, const size_t* terms)
+{
+    auto mWord = m >> 6;
+    auto mShift = m & 0x3f;
+
+    for (auto i = top; i > mWord; --i) {
+        auto t = r[i];
+        r[i] = 0;
+        for (size_t j = 0; j < N; ++j) {
+            FoldWord(r, i, t, m, terms[j]);
+        }
+    }
+
+    auto t = r[mWord] >> mShift;
+    if (t == 0) {
+        return;
+    }
+
+    r[mWord] ^= t << mShift;
+    for (size_t j = 0; j < N; ++j) {
+        FoldTop(r, t, terms[j]);
+    }
+}
+
+// a fold may land back in the word being reduced, so words are revisited until clear
+static void ReduceGeneric(uint64_t* r, size_t top, size_t m, const std::vector<size_t>& terms)
+{
+    auto mWord = m >> 6;
+    auto mShift = m & 0x3f;
+
+    auto i = top;
+    while (i > mWord) {
+        auto t = r[i];
+        if (t == 0) {
+            --i;
+            continue;
+        }
+
+        r[i] = 0;
+        for (auto k : terms) {
+            FoldWord(r, i, t, m, k);
+        }
+    }
+
+    while (true) {
+        auto t = r[mWord] >> mShift;
+        if (t == 0) {
+            break;
+        }
+
+        r[mWord] ^= t << mShift;
+        for (auto k : terms) {
+            FoldTop(r, t, k);
+        }
+    }
+}
+
+// spreads the 32 bits of x over the even bit positions of a word
+static inline uint64_t Spread(uint64_t x)
+{
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x <<  8)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x <<  4)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x <<  2)) & 0x3333333333333333ULL;
+    x = (x | (x <<  1)) & 0x5555555555555555ULL;
+    return x;
+}
+
+GF2Modulus::GF2Modulus() : modulus(), degree(0), kind(Kind::Generic)
+{}
+
+GF2Modulus::GF2Modulus(const GF2Polynomial& modulus) : modulus(modulus.Reduce()), degree(0), kind(Kind::Generic)
+{
+    if (modulus.IsZero()) {
+        throw std::invalid_argument("devide by zero is not allowed");
+    }
+
+    degree = this->modulus.Length() - 1;
+    for (auto i = degree; i > 0; --i) {
+        if (this->modulus.GetBit(i - 1) != 0) {
+            terms.push_back(i - 1);
+        }
+    }
+
+    if (!terms.empty() && (degree - terms.front() >= 64)) {
+        if (terms.size() == 2) {
+            kind = Kind::Trinomial;
+        } else if (terms.size() == 4) {
+            kind = Kind::Pentanomial;
+        }
+    }
+}
+
+size_t GF2Modulus::Degree() const
+{
+    return degree;
+}
+
+GF2Modulus::Kind GF2Modulus::Type() const
+{
+    return kind;
+}
+
+const GF2Polynomial& GF2Modulus::Polynomial() const
+{
+    return modulus;
+}
+
+void GF2Modulus::Reduce(std::vector<uint64_t>& words) const
+{
+    Reduce(words.data(), words.size());
+}
+
+void GF2Modulus::Reduce(uint64_t* words, size_t count) const
+{
+    if (count <= (degree >> 6)) {
+        return;
+    }
+
+    auto top = count - 1;
+    switch (kind) {
+    case Kind::Trinomial:
+        ReduceSparse<2>(words, top, degree, terms.data());
+        break;
+
+    case Kind::Pentanomial:
+        ReduceSparse<4>(words, top, degree, terms.data());
+        break;
+
+    default:
+        ReduceGeneric(words, top, degree, terms);
+        break;
+    }
+}
+
+GF2Polynomial GF2Modulus::Reduce(const GF2Polynomial& poly) const
+{
+    auto words = ScratchVector<uint64_t>(poly.WordLength());
+    poly.Words(words.data());
+    Reduce(words.data(), words.size());
+
+    return GF2Polynomial::FromWords(degree, words.data(), words.size());
+}
+
+GF2Polynomial GF2Modulus::Multiply(const GF2Polynomial& lhs, const GF2Polynomial& rhs) const
+{
+    return Reduce(lhs * rhs);
+}
+
+GF2Polynomial GF2Modulus::Square(const GF2Polynomial& poly) const
+{
+    auto count = poly.WordLength();
+    auto square = ScratchVector<uint64_t>(count << 1);
+    poly.Words(square.data() + count);
+    for (size_t i = 0; i < count; ++i) {
+        auto word = square[count + i];
+        square[(i << 1)    ] = Spread(word & 0xffffffff);
+        square[(i << 1) + 1] = Spread(word >> 32);
+    }
+
+    Reduce(square.data(), square.size());
+
+    return GF2Polynomial::FromWords(degree, square.data(), square.size());
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_GF2_MODULUS_H__
+#define __ECC_GF2_MODULUS_H__
+
+#include "GF2Polynomial.h"
+#include <vector>
+#include <cstdint>
+
+namespace ecc
+{
+    // reduction modulo a fixed irreducible polynomial f(x), done in place on 64-bit words.
+    // trinomials and pentanomials whose middle terms sit at least one word below the degree
+    // take an unrolled single-pass path, every other modulus falls back to a generic term loop.
+    class GF2Modulus
+    {
+    public:
+        enum class Kind { Trinomial, Pentanomial, Generic };
+
+    private:
+        GF2Polynomial modulus;
+        size_t degree;
+        std::vector<size_t> terms;
+        Kind kind;
+
+    public:
+        GF2Modulus();
+        GF2Modulus(const GF2Polynomial& modulus);
+        GF2Modulus(const GF2Modulus& other) = default;
+        GF2Modulus(GF2Modulus&& other) = default;
+        ~GF2Modulus() = default;
+
+        GF2Modulus& operator=(const GF2Modulus& other) = default;
+        GF2Modulus& operator=(GF2Modulus&& other) = default;
+
+        size_t Degree() const;
+        Kind Type() const;
+        const GF2Polynomial& Polynomial() const;
+
+        void Reduce(std::vector<uint64_t>& words) const;
+        void Reduce(uint64_t* words, size_t count) const;
+
+        GF2Polynomial Reduce(const GF2Polynomial& poly) const;
+        GF2Polynomial Multiply(const GF2Polynomial& lhs, const GF2Polynomial& rhs) const;
+        GF2Polynomial Square(const GF2Polynomial& poly) const;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -1,87 +1,103 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#ifndef __ECC_GF2_POLYNOMIAL_H__
-#define __ECC_GF2_POLYNOMIAL_H__
-
-#include "BigNum.h"
-#include <vector>
-#include <cstdint>
-
-namespace ecc
-{
-    class GF2Polynomial
-    {
-    public:
-        size_t length;
-        std::vector<uint32_t> value;
-
-    public:
-        GF2Polynomial();
-        GF2Polynomial(size_t length);
-        GF2Polynomial(size_t length, const std::vector<uint32_t>& data);
-        GF2Polynomial(size_t length, const BigNum& num);
-        GF2Polynomial(const BigNum& num);
-        GF2Polynomial(const GF2Polynomial& other);
-        ~GF2Polynomial();
-
-        size_t Length() const;
-        size_t BlockLength() const;
-        std::vector<uint32_t> Value() const;
-
-        bool IsZero() const;
-        uint8_t GetBit(size_t idx) const;
-        void SetBit(size_t idx);
-        void SetBit(const std::initializer_list<size_t>& idxList);
-
-        GF2Polynomial Expand(size_t length) const;
-        GF2Polynomial Reduce() const;
-
-        GF2Polynomial ShiftLeft(size_t numBits) const;
-        GF2Polynomial ShiftBlocksLeft(size_t numBlocks) const;
-
-        uint32_t& operator[](size_t pos);
-        const uint32_t& operator[](size_t pos) const;
-
-        GF2Polynomial& operator=(const GF2Polynomial& rhs);
-        GF2Polynomial& operator^=(const GF2Polynomial& rhs);
-
-        GF2Polynomial operator^(const GF2Polynomial& rhs) const;
-        GF2Polynomial operator+(const GF2Polynomial& rhs) const;
-        GF2Polynomial operator-(const GF2Polynomial& rhs) const;
-        GF2Polynomial operator*(const GF2Polynomial& rhs) const;
-        GF2Polynomial operator%(const GF2Polynomial& other) const;
-
-        GF2Polynomial ReverseBits() const;
-
-        std::string ToBitString() const;
-        std::string ToHexIntString() const;
-        BigNum ToBigNum() const;
-
-    private:
-        void ZeroUnusedBits();
-    };
-}
-
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_GF2_POLYNOMIAL_H__
+#define __ECC_GF2_POLYNOMIAL_H__
+
+#include "BigNum.h"
+#include <vector>
+#include <cstdint>
+
+namespace ecc
+{
+    class GF2Polynomial
+    {
+    public:
+        // word multiplication kernel: Auto uses carry-less multiply when the cpu has it, Comb always uses the portable comb
+        enum class Kernel { Auto, Comb };
+
+    public:
+        size_t length;
+        std::vector<uint32_t> value;
+
+    public:
+        GF2Polynomial();
+        GF2Polynomial(size_t length);
+        GF2Polynomial(size_t length, const std::vector<uint32_t>& data);
+        GF2Polynomial(size_t length, const BigNum& num);
+        GF2Polynomial(const BigNum& num);
+        GF2Polynomial(const GF2Polynomial& other);
+        GF2Polynomial(GF2Polynomial&& other) noexcept;
+        ~GF2Polynomial();
+
+        size_t Length() const;
+        size_t BlockLength() const;
+        size_t WordLength() const;
+        std::vector<uint32_t> Value() const;
+        std::vector<uint64_t> Words() const;
+        void Words(uint64_t* words) const;
+
+        static GF2Polynomial FromWords(size_t length, const std::vector<uint64_t>& words);
+        static GF2Polynomial FromWords(size_t length, const uint64_t* words, size_t count);
+
+        bool IsZero() const;
+        uint8_t GetBit(size_t idx) const;
+        void SetBit(size_t idx);
+        void SetBit(const std::initializer_list<size_t>& idxList);
+
+        GF2Polynomial Expand(size_t length) const;
+        GF2Polynomial Reduce() const;
+
+        GF2Polynomial ShiftLeft(size_t numBits) const;
+        GF2Polynomial ShiftBlocksLeft(size_t numBlocks) const;
+
+        uint32_t& operator[](size_t pos);
+        const uint32_t& operator[](size_t pos) const;
+
+        GF2Polynomial& operator=(const GF2Polynomial& rhs);
+        GF2Polynomial& operator=(GF2Polynomial&& rhs) noexcept;
+        GF2Polynomial& operator^=(const GF2Polynomial& rhs);
+        GF2Polynomial& operator*=(const GF2Polynomial& rhs);
+        GF2Polynomial& operator%=(const GF2Polynomial& other);
+
+        GF2Polynomial operator^(const GF2Polynomial& rhs) const;
+        GF2Polynomial operator+(const GF2Polynomial& rhs) const;
+        GF2Polynomial operator-(const GF2Polynomial& rhs) const;
+        GF2Polynomial operator*(const GF2Polynomial& rhs) const;
+        GF2Polynomial operator%(const GF2Polynomial& other) const;
+
+        static GF2Polynomial Multiply(const GF2Polynomial& lhs, const GF2Polynomial& rhs, Kernel kernel);
+
+        GF2Polynomial ReverseBits() const;
+
+        std::string ToBitString() const;
+        std::string ToHexIntString() const;
+        BigNum ToBigNum() const;
+
+    private:
+        void ZeroUnusedBits();
+    };
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LazyBasisConversion.h"
+
+#include <stdexcept>
+
+using namespace ecc;
+
+LazyBasisConversion::LazyBasisConversion() : ready(false)
+{}
+
+LazyBasisConversion::LazyBasisConversion(const std::function<BasisConversion()>& factory) : factory(factory), ready(false)
+{}
+
+LazyBasisConversion::LazyBasisConversion(const BasisConversion& conversion) : ready(true), conversion(conversion)
+{}
+
+bool LazyBasisConversion::Available() const
+{
+    return ready.load(std::memory_order_acquire) || factory;
+}
+
+bool LazyBasisConversion::Built() const
+{
+    return ready.load(std::memory_order_acquire);
+}
+
+// a factory that throws leaves the conversion unbuilt, so the next call tries again
+const BasisConversion& LazyBasisConversion::Get() const
+{
+    if (ready.load(std::memory_order_acquire)) {
+        return conversion;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ready.load(std::memory_order_relaxed)) {
+        if (!factory) {
+            throw std::logic_error("BasisConversion is not available for this curve");
+        }
+
+        conversion = factory();
+        ready.store(true, std::memory_order_release);
+    }
+
+    return conversion;
+}
\ No newline at end of file
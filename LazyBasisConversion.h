@@ -0,0 +1,63 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_LAZY_BASIS_CONVERSION_H__
+#define __ECC_LAZY_BASIS_CONVERSION_H__
+
+#include "BasisConversion.h"
+
+#include <functional>
+#include <atomic>
+#include <mutex>
+
+namespace ecc
+{
+    // builds a BasisConversion on first use; a default constructed one is never available,
+    // which is what prime field curves and binary curves without a normal basis root get
+    class LazyBasisConversion
+    {
+    private:
+        std::function<BasisConversion()> factory;
+
+        mutable std::mutex mutex;
+        mutable std::atomic<bool> ready;
+        mutable BasisConversion conversion;
+
+    public:
+        LazyBasisConversion();
+        LazyBasisConversion(const std::function<BasisConversion()>& factory);
+        LazyBasisConversion(const BasisConversion& conversion);
+        ~LazyBasisConversion() = default;
+
+        LazyBasisConversion(const LazyBasisConversion&) = delete;
+        LazyBasisConversion& operator=(const LazyBasisConversion&) = delete;
+
+        bool Available() const;
+        bool Built() const;
+
+        const BasisConversion& Get() const;
+    };
+}
+
+#endif
\ No newline at end of file
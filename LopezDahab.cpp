@@ -0,0 +1,286 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LopezDahab.h"
+#include <stdexcept>
+
+using namespace ecc;
+
+LDPoint::LDPoint() : X(BN_new()), Y(BN_new()), Z(BN_new())
+{}
+
+LopezDahab::LopezDahab(const EC_GROUP* group) : a(BN_new()), b(BN_new())
+{
+    BigNum p(BN_new());
+    EC_GROUP_get_curve(group, p.RawPtr(), a.RawPtr(), b.RawPtr(), nullptr);
+
+    // trinomial or pentanomial, plus the terminating -1 counted by BN_GF2m_poly2arr
+    irreducible = std::vector<int>(6, -1);
+    auto terms = BN_GF2m_poly2arr(p.RawPtr(), irreducible.data(), irreducible.size());
+    if ((terms == 0) || (terms > static_cast<int>(irreducible.size()))) {
+        throw std::invalid_argument("LopezDahab: irreducible polynomial has too many terms");
+    }
+}
+
+bool LopezDahab::IsInfinity(const LDPoint& point) const
+{
+    return BN_is_zero(point.Z.RawPtr());
+}
+
+void LopezDahab::SetInfinity(LDPoint& point) const
+{
+    BN_one(point.X.RawPtr());
+    BN_zero(point.Y.RawPtr());
+    BN_zero(point.Z.RawPtr());
+}
+
+void LopezDahab::Copy(LDPoint& dst, const LDPoint& src) const
+{
+    BN_copy(dst.X.RawPtr(), src.X.RawPtr());
+    BN_copy(dst.Y.RawPtr(), src.Y.RawPtr());
+    BN_copy(dst.Z.RawPtr(), src.Z.RawPtr());
+}
+
+bool LopezDahab::Import(LDPoint& dst, const EC_GROUP* group, const EC_POINT* src, BN_CTX* ctx) const
+{
+    if (EC_POINT_is_at_infinity(group, src)) {
+        SetInfinity(dst);
+        return true;
+    }
+
+    BN_one(dst.Z.RawPtr());
+    return 1 == EC_POINT_get_affine_coordinates(group, src, dst.X.RawPtr(), dst.Y.RawPtr(), ctx);
+}
+
+bool LopezDahab::Export(const EC_GROUP* group, EC_POINT* dst, const LDPoint& src, BN_CTX* ctx) const
+{
+    if (IsInfinity(src)) {
+        return 1 == EC_POINT_set_to_infinity(group, dst);
+    }
+
+    auto arr = irreducible.data();
+
+    BN_CTX_start(ctx);
+    auto x = BN_CTX_get(ctx);
+    auto y = BN_CTX_get(ctx);
+    auto zinv = BN_CTX_get(ctx);
+
+    // (x, y) = (X / Z, Y / Z^2)
+    auto success = (zinv != NULL) && (1 == BN_GF2m_mod_inv_arr(zinv, src.Z.RawPtr(), arr, ctx));
+    if (success) {
+        BN_GF2m_mod_mul_arr(x, src.X.RawPtr(), zinv, arr, ctx);
+        BN_GF2m_mod_sqr_arr(zinv, zinv, arr, ctx);
+        BN_GF2m_mod_mul_arr(y, src.Y.RawPtr(), zinv, arr, ctx);
+
+        success = (1 == EC_POINT_set_affine_coordinates(group, dst, x, y, ctx));
+    }
+
+    BN_CTX_end(ctx);
+    return success;
+}
+
+void LopezDahab::Double(LDPoint& point, BN_CTX* ctx) const
+{
+    if (IsInfinity(point)) {
+        return;
+    }
+
+    auto arr = irreducible.data();
+    auto X = point.X.RawPtr();
+    auto Y = point.Y.RawPtr();
+    auto Z = point.Z.RawPtr();
+
+    BN_CTX_start(ctx);
+    auto t1 = BN_CTX_get(ctx);
+    auto t2 = BN_CTX_get(ctx);
+
+    BN_GF2m_mod_sqr_arr(t1, Z, arr, ctx);           // Z1^2
+    BN_GF2m_mod_sqr_arr(t2, X, arr, ctx);           // X1^2
+    BN_GF2m_mod_mul_arr(Z, t1, t2, arr, ctx);       // Z3 = X1^2 * Z1^2
+    BN_GF2m_mod_sqr_arr(t1, t1, arr, ctx);
+    BN_GF2m_mod_mul_arr(t1, t1, b.RawPtr(), arr, ctx);  // b * Z1^4
+    BN_GF2m_mod_sqr_arr(X, t2, arr, ctx);
+    BN_GF2m_add(X, X, t1);                          // X3 = X1^4 + b * Z1^4
+
+    BN_GF2m_mod_sqr_arr(Y, Y, arr, ctx);
+    BN_GF2m_add(Y, Y, t1);
+    if (!BN_is_zero(a.RawPtr())) {
+        BN_GF2m_mod_mul_arr(t2, a.RawPtr(), Z, arr, ctx);
+        BN_GF2m_add(Y, Y, t2);
+    }
+    BN_GF2m_mod_mul_arr(Y, Y, X, arr, ctx);
+    BN_GF2m_mod_mul_arr(t1, t1, Z, arr, ctx);
+    BN_GF2m_add(Y, Y, t1);                          // Y3 = b * Z1^4 * Z3 + X3 * (a * Z3 + Y1^2 + b * Z1^4)
+
+    BN_CTX_end(ctx);
+}
+
+void LopezDahab::Add(LDPoint& point, const LDPoint& other, BN_CTX* ctx) const
+{
+    if (IsInfinity(other)) {
+        return;
+    }
+
+    if (IsInfinity(point)) {
+        Copy(point, other);
+        return;
+    }
+
+    if (BN_is_one(other.Z.RawPtr())) {
+        AddAffine(point, other.X.RawPtr(), other.Y.RawPtr(), ctx);
+        return;
+    }
+
+    auto arr = irreducible.data();
+    auto X1 = point.X.RawPtr();
+    auto Y1 = point.Y.RawPtr();
+    auto Z1 = point.Z.RawPtr();
+    auto X2 = other.X.RawPtr();
+    auto Y2 = other.Y.RawPtr();
+    auto Z2 = other.Z.RawPtr();
+
+    BN_CTX_start(ctx);
+    auto A = BN_CTX_get(ctx);
+    auto B = BN_CTX_get(ctx);
+    auto C = BN_CTX_get(ctx);
+    auto C1 = BN_CTX_get(ctx);
+    auto D = BN_CTX_get(ctx);
+    auto G = BN_CTX_get(ctx);
+    auto t = BN_CTX_get(ctx);
+
+    BN_GF2m_mod_sqr_arr(t, Z2, arr, ctx);
+    BN_GF2m_mod_mul_arr(A, Y1, t, arr, ctx);
+    BN_GF2m_mod_mul_arr(G, Z1, t, arr, ctx);        // Z1 * Z2^2
+    BN_GF2m_mod_sqr_arr(t, Z1, arr, ctx);
+    BN_GF2m_mod_mul_arr(t, Y2, t, arr, ctx);
+    BN_GF2m_add(A, A, t);                           // A = Y1 * Z2^2 + Y2 * Z1^2
+    BN_GF2m_mod_mul_arr(C1, X1, Z2, arr, ctx);
+    BN_GF2m_mod_mul_arr(B, X2, Z1, arr, ctx);
+    BN_GF2m_add(B, B, C1);                          // B = X1 * Z2 + X2 * Z1
+
+    if (BN_is_zero(B)) {
+        if (BN_is_zero(A)) {
+            Double(point, ctx);
+        } else {
+            SetInfinity(point);
+        }
+
+        BN_CTX_end(ctx);
+        return;
+    }
+
+    BN_GF2m_mod_sqr_arr(t, B, arr, ctx);
+    BN_GF2m_mod_mul_arr(G, G, t, arr, ctx);
+    BN_GF2m_mod_sqr_arr(G, G, arr, ctx);
+    BN_GF2m_mod_mul_arr(G, G, Y1, arr, ctx);        // G = Y1 * (Z1 * Z2^2 * B^2)^2
+
+    BN_GF2m_mod_mul_arr(C, Z1, Z2, arr, ctx);       // W = Z1 * Z2
+    if (BN_is_zero(a.RawPtr())) {
+        BN_GF2m_mod_mul_arr(C, C, B, arr, ctx);     // C = W * B
+        BN_GF2m_mod_mul_arr(D, t, C, arr, ctx);
+    } else {
+        BN_GF2m_mod_sqr_arr(D, C, arr, ctx);
+        BN_GF2m_mod_mul_arr(D, D, a.RawPtr(), arr, ctx);
+        BN_GF2m_mod_mul_arr(C, C, B, arr, ctx);
+        BN_GF2m_add(D, D, C);
+        BN_GF2m_mod_mul_arr(D, D, t, arr, ctx);     // D = B^2 * (C + a * W^2)
+    }
+
+    BN_GF2m_mod_mul_arr(t, A, C, arr, ctx);         // E = A * C
+    BN_GF2m_mod_sqr_arr(X1, A, arr, ctx);
+    BN_GF2m_add(X1, X1, t);
+    BN_GF2m_add(X1, X1, D);                         // X3 = A^2 + E + D
+    BN_GF2m_mod_sqr_arr(Z1, C, arr, ctx);           // Z3 = C^2
+
+    BN_GF2m_mod_mul_arr(C1, C1, B, arr, ctx);
+    BN_GF2m_mod_mul_arr(C1, C1, C, arr, ctx);
+    BN_GF2m_add(C1, C1, X1);                        // F = X1 * Z2 * B * C + X3
+    BN_GF2m_mod_mul_arr(Y1, t, C1, arr, ctx);
+    BN_GF2m_mod_mul_arr(t, X1, Z1, arr, ctx);
+    BN_GF2m_add(Y1, Y1, t);
+    BN_GF2m_add(Y1, Y1, G);                         // Y3 = E * F + X3 * Z3 + G
+
+    BN_CTX_end(ctx);
+}
+
+void LopezDahab::AddAffine(LDPoint& point, const BIGNUM* x, const BIGNUM* y, BN_CTX* ctx) const
+{
+    auto arr = irreducible.data();
+    auto X = point.X.RawPtr();
+    auto Y = point.Y.RawPtr();
+    auto Z = point.Z.RawPtr();
+
+    BN_CTX_start(ctx);
+    auto A = BN_CTX_get(ctx);
+    auto B = BN_CTX_get(ctx);
+    auto C = BN_CTX_get(ctx);
+    auto D = BN_CTX_get(ctx);
+    auto E = BN_CTX_get(ctx);
+    auto t = BN_CTX_get(ctx);
+
+    BN_GF2m_mod_sqr_arr(t, Z, arr, ctx);
+    BN_GF2m_mod_mul_arr(A, y, t, arr, ctx);
+    BN_GF2m_add(A, A, Y);                           // A = y * Z1^2 + Y1
+    BN_GF2m_mod_mul_arr(B, x, Z, arr, ctx);
+    BN_GF2m_add(B, B, X);                           // B = x * Z1 + X1
+
+    if (BN_is_zero(B)) {
+        if (BN_is_zero(A)) {
+            BN_copy(X, x);
+            BN_copy(Y, y);
+            BN_one(Z);
+            Double(point, ctx);
+        } else {
+            SetInfinity(point);
+        }
+
+        BN_CTX_end(ctx);
+        return;
+    }
+
+    BN_GF2m_mod_mul_arr(C, Z, B, arr, ctx);         // C = Z1 * B
+    if (BN_is_zero(a.RawPtr())) {
+        BN_copy(D, C);
+    } else {
+        BN_GF2m_mod_mul_arr(t, t, a.RawPtr(), arr, ctx);
+        BN_GF2m_add(D, C, t);
+    }
+    BN_GF2m_mod_sqr_arr(t, B, arr, ctx);
+    BN_GF2m_mod_mul_arr(D, D, t, arr, ctx);         // D = B^2 * (C + a * Z1^2)
+    BN_GF2m_mod_sqr_arr(Z, C, arr, ctx);            // Z3 = C^2
+    BN_GF2m_mod_mul_arr(E, A, C, arr, ctx);         // E = A * C
+    BN_GF2m_mod_sqr_arr(X, A, arr, ctx);
+    BN_GF2m_add(X, X, D);
+    BN_GF2m_add(X, X, E);                           // X3 = A^2 + D + E
+    BN_GF2m_mod_mul_arr(t, x, Z, arr, ctx);
+    BN_GF2m_add(t, t, X);                           // F = X3 + x * Z3
+    BN_GF2m_add(E, E, Z);
+    BN_GF2m_mod_mul_arr(Y, E, t, arr, ctx);
+    BN_GF2m_add(t, x, y);
+    BN_GF2m_mod_sqr_arr(D, Z, arr, ctx);
+    BN_GF2m_mod_mul_arr(t, t, D, arr, ctx);
+    BN_GF2m_add(Y, Y, t);                           // Y3 = (E + Z3) * F + (x + y) * Z3^2
+
+    BN_CTX_end(ctx);
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_LOPEZ_DAHAB_H__
+#define __ECC_LOPEZ_DAHAB_H__
+
+#include "BigNum.h"
+
+#include <openssl/ec.h>
+#include <vector>
+
+namespace ecc
+{
+    // LDPoint : Lopez-Dahab projective point, (x, y) = (X / Z, Y / Z^2), Z = 0 is the point at infinity
+    class LDPoint
+    {
+    public:
+        BigNum X;
+        BigNum Y;
+        BigNum Z;
+
+    public:
+        LDPoint();
+    };
+
+    // LopezDahab : point arithmetic on y^2 + xy = x^3 + ax^2 + b over GF(2^m) without field inversions
+    //
+    // OpenSSL keeps GF2m points in affine form and pays an inversion for every addition,
+    // so the hot loops over binary curves use this instead and convert only at the end.
+    class LopezDahab
+    {
+    private:
+        std::vector<int> irreducible;
+        BigNum a;
+        BigNum b;
+
+    public:
+        LopezDahab(const EC_GROUP* group);
+        ~LopezDahab() = default;
+
+        bool IsInfinity(const LDPoint& point) const;
+        void SetInfinity(LDPoint& point) const;
+        void Copy(LDPoint& dst, const LDPoint& src) const;
+
+        bool Import(LDPoint& dst, const EC_GROUP* group, const EC_POINT* src, BN_CTX* ctx) const;
+        bool Export(const EC_GROUP* group, EC_POINT* dst, const LDPoint& src, BN_CTX* ctx) const;
+
+        void Double(LDPoint& point, BN_CTX* ctx) const;
+        void Add(LDPoint& point, const LDPoint& other, BN_CTX* ctx) const;
+
+    private:
+        void AddAffine(LDPoint& point, const BIGNUM* x, const BIGNUM* y, BN_CTX* ctx) const;
+    };
+}
+
+#endif
\ No newline at end of file
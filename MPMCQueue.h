@@ -0,0 +1,126 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_MPMC_QUEUE_H__
+#define __ECC_MPMC_QUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace ecc
+{
+    // MPMCQueue : bounded lock-free multi-producer multi-consumer queue (Vyukov)
+    //
+    // every cell carries a sequence number telling producers and consumers whose turn it is,
+    // so a push or a pop is one CAS on the shared position and one release store on the cell.
+    // TryPush and TryPop fail instead of waiting when the queue is full or empty.
+    template <typename T>
+    class MPMCQueue
+    {
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        // producers and consumers spin on different cache lines
+        static const size_t CACHE_LINE = 64;
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+
+        alignas(CACHE_LINE) std::atomic<size_t> tail;
+        alignas(CACHE_LINE) std::atomic<size_t> head;
+
+    public:
+        explicit MPMCQueue(size_t capacity) : mask(capacity - 1), tail(0), head(0)
+        {
+            if ((capacity < 2) || ((capacity & (capacity - 1)) != 0)) {
+                throw std::invalid_argument("MPMCQueue: capacity must be a power of two");
+            }
+
+            cells.reset(new Cell[capacity]);
+            for (size_t i = 0; i < capacity; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        size_t Capacity() const
+        {
+            return mask + 1;
+        }
+
+        bool TryPush(const T& value)
+        {
+            auto pos = tail.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells[pos & mask];
+                auto seq = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0) {
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.value = value;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool TryPop(T& value)
+        {
+            auto pos = head.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells[pos & mask];
+                auto seq = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0) {
+                    if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        value = std::move(cell.value);
+                        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Metrics.h"
+
+using namespace ecc;
+
+const size_t Metrics::SHARDS;
+const size_t Metrics::BUCKETS;
+
+namespace
+{
+    std::atomic<uint64_t> contexts(0);
+    std::atomic<size_t> nextShard(0);
+
+    // each thread keeps the shard it was first given
+    size_t ShardIndex()
+    {
+        static thread_local size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % Metrics::SHARDS;
+        return index;
+    }
+
+    size_t Bucket(uint64_t ns)
+    {
+        size_t bucket = (ns == 0) ? 0 : (64 - __builtin_clzll(ns));
+        return (bucket < Metrics::BUCKETS) ? bucket : (Metrics::BUCKETS - 1);
+    }
+}
+
+const char* ecc::OperationName(Operation op)
+{
+    switch (op) {
+    case Operation::Multiply:
+        return "multiply";
+    case Operation::Add:
+        return "add";
+    case Operation::Invert:
+        return "invert";
+    case Operation::Decompress:
+        return "decompress";
+    case Operation::Validate:
+        return "validate";
+    case Operation::ConvertBasis:
+        return "convert_basis";
+    default:
+        return "unknown";
+    }
+}
+
+// value-initialized, so every counter starts at zero
+Metrics::Metrics() : shards(SHARDS)
+{}
+
+void Metrics::Record(Operation op, uint64_t count, uint64_t ns)
+{
+    auto idx = static_cast<size_t>(op);
+    auto& shard = shards[ShardIndex()];
+
+    shard.counts[idx].fetch_add(count, std::memory_order_relaxed);
+    shard.calls[idx].fetch_add(1, std::memory_order_relaxed);
+    shard.totalNs[idx].fetch_add(ns, std::memory_order_relaxed);
+    shard.histogram[idx][Bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// sums the shards; concurrent recording may land in either this snapshot or the next
+MetricsSnapshot Metrics::Snapshot() const
+{
+    auto snapshot = Disabled();
+    snapshot.enabled = true;
+
+    for (auto& shard : shards) {
+        for (size_t op = 0; op < OPERATIONS; ++op) {
+            auto& entry = snapshot.operations[op];
+            entry.count += shard.counts[op].load(std::memory_order_relaxed);
+            entry.calls += shard.calls[op].load(std::memory_order_relaxed);
+            entry.totalNs += shard.totalNs[op].load(std::memory_order_relaxed);
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                entry.histogram[b] += shard.histogram[op][b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+void Metrics::CountContext()
+{
+    contexts.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsSnapshot Metrics::Disabled()
+{
+    MetricsSnapshot snapshot;
+    snapshot.enabled = false;
+    snapshot.contexts = contexts.load(std::memory_order_relaxed);
+    snapshot.operations.resize(OPERATIONS);
+    for (auto& entry : snapshot.operations) {
+        entry.count = 0;
+        entry.calls = 0;
+        entry.totalNs = 0;
+        entry.histogram.assign(BUCKETS, 0);
+    }
+    return snapshot;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_METRICS_H__
+#define __ECC_METRICS_H__
+
+#include "AlignedAllocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecc
+{
+    enum class Operation : size_t {
+        Multiply,
+        Add,
+        Invert,
+        Decompress,
+        Validate,
+        ConvertBasis,
+        Count,
+    };
+
+    const char* OperationName(Operation op);
+
+    struct MetricsSnapshot {
+        struct Entry {
+            // elements processed, e.g. one per point of a batch, and calls with their total latency
+            uint64_t count;
+            uint64_t calls;
+            uint64_t totalNs;
+            // histogram[i] counts calls that took [2^(i-1), 2^i) ns, histogram[0] those under 1 ns
+            std::vector<uint64_t> histogram;
+        };
+
+        bool enabled;
+        std::vector<Entry> operations;
+        // BN_CTX created by BNContext, process-wide as contexts are per thread rather than per curve
+        uint64_t contexts;
+    };
+
+    // Metrics : per-curve operation counters and log2 latency histograms
+    //
+    // recording only happens when the library is built with ECC_ENABLE_METRICS; otherwise the group
+    // holds no Metrics and every ECC_METRIC_SCOPE compiles to nothing. threads are spread over SHARDS
+    // cache-line aligned shards of relaxed atomics, so recording never locks and rarely shares a line.
+    class Metrics
+    {
+    public:
+        static const size_t SHARDS = 16;
+        static const size_t BUCKETS = 40;
+
+    private:
+        static const size_t OPERATIONS = static_cast<size_t>(Operation::Count);
+
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> counts[OPERATIONS];
+            std::atomic<uint64_t> calls[OPERATIONS];
+            std::atomic<uint64_t> totalNs[OPERATIONS];
+            std::atomic<uint64_t> histogram[OPERATIONS][BUCKETS];
+        };
+
+        static_assert(sizeof(Shard) % 64 == 0, "a Shard must fill whole cache lines");
+
+        // std::allocator ignores alignas(64) before C++17, so shards could share a line without this
+        std::vector<Shard, AlignedAllocator<Shard, alignof(Shard)>> shards;
+
+    public:
+        Metrics();
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        void Record(Operation op, uint64_t count, uint64_t ns);
+        MetricsSnapshot Snapshot() const;
+
+        static void CountContext();
+        static MetricsSnapshot Disabled();
+    };
+
+    // records one call of `op` over `count` elements, timed from construction to destruction
+    class MetricScope
+    {
+    private:
+        Metrics* metrics;
+        Operation op;
+        uint64_t count;
+        std::chrono::steady_clock::time_point begin;
+
+    public:
+        MetricScope(Metrics* metrics, Operation op, uint64_t count) : metrics(metrics), op(op), count(count)
+        {
+            if (metrics != nullptr) {
+                begin = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~MetricScope()
+        {
+            if (metrics != nullptr) {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+                metrics->Record(op, count, static_cast<uint64_t>(ns));
+            }
+        }
+
+        MetricScope(const MetricScope&) = delete;
+        MetricScope& operator=(const MetricScope&) = delete;
+    };
+}
+
+#if defined(ECC_ENABLE_METRICS)
+#define ECC_METRIC_CONCAT_(a, b) a##b
+#define ECC_METRIC_CONCAT(a, b) ECC_METRIC_CONCAT_(a, b)
+#define ECC_METRIC_SCOPE(group, op, count) ecc::MetricScope ECC_METRIC_CONCAT(eccMetricScope, __LINE__)((group).Recorder(), (op), (count))
+#else
+#define ECC_METRIC_SCOPE(group, op, count) ((void)0)
+#endif
+
+#endif
\ No newline at end of file
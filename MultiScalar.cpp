@@ -0,0 +1,469 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MultiScalar.h"
+#include "BigNum.h"
+#include "BNContext.h"
+#include "ECAffine.h"
+#include "LopezDahab.h"
+#include "Parallel.h"
+
+#include <stdexcept>
+#include <memory>
+#include <algorithm>
+#include <openssl/obj_mac.h>
+
+using namespace ecc;
+
+const size_t MultiScalar::STRAUS_THRESHOLD = 32;
+const size_t MultiScalar::STRAUS_WINDOW = 4;
+
+namespace
+{
+    class PrimePoint
+    {
+    public:
+        EC_POINT* raw;
+
+    public:
+        PrimePoint(const EC_GROUP* group) : raw(EC_POINT_new(group))
+        {}
+
+        PrimePoint(const PrimePoint& other) = delete;
+
+        PrimePoint(PrimePoint&& other) noexcept : raw(other.raw)
+        {
+            other.raw = nullptr;
+        }
+
+        ~PrimePoint()
+        {
+            EC_POINT_free(raw);
+        }
+    };
+
+    // prime fields: OpenSSL already works in Jacobian coordinates and uses mixed additions for affine operands
+    class PrimeField
+    {
+    private:
+        const EC_GROUP* group;
+        BN_CTX* ctx;
+
+    public:
+        typedef PrimePoint Point;
+
+    public:
+        PrimeField(const EC_GROUP* group, BN_CTX* ctx, const LopezDahab*) : group(group), ctx(ctx)
+        {}
+
+        std::vector<Point> Allocate(size_t count) const
+        {
+            std::vector<Point> points;
+            points.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                points.emplace_back(group);
+            }
+            return points;
+        }
+
+        void SetInfinity(Point& point) const
+        {
+            EC_POINT_set_to_infinity(group, point.raw);
+        }
+
+        void Copy(Point& dst, const Point& src) const
+        {
+            EC_POINT_copy(dst.raw, src.raw);
+        }
+
+        bool Import(Point& dst, const EC_POINT* src) const
+        {
+            return 1 == EC_POINT_copy(dst.raw, src);
+        }
+
+        bool Export(EC_POINT* dst, const Point& src) const
+        {
+            return 1 == EC_POINT_copy(dst, src.raw);
+        }
+
+        void Double(Point& point) const
+        {
+            EC_POINT_dbl(group, point.raw, point.raw, ctx);
+        }
+
+        void Add(Point& point, const Point& other) const
+        {
+            EC_POINT_add(group, point.raw, point.raw, other.raw, ctx);
+        }
+
+        void MakeAffine(std::vector<Point>& points) const
+        {
+            std::vector<EC_POINT*> raw;
+            raw.reserve(points.size());
+            for (auto& point : points) {
+                raw.push_back(point.raw);
+            }
+
+            ecc::MakeAffine(group, raw.size(), raw.data(), ctx);
+        }
+    };
+
+    class BinaryField
+    {
+    private:
+        const EC_GROUP* group;
+        BN_CTX* ctx;
+        const LopezDahab* arithmetic;
+
+    public:
+        typedef LDPoint Point;
+
+    public:
+        BinaryField(const EC_GROUP* group, BN_CTX* ctx, const LopezDahab* arithmetic) : group(group), ctx(ctx), arithmetic(arithmetic)
+        {}
+
+        std::vector<Point> Allocate(size_t count) const
+        {
+            return std::vector<Point>(count);
+        }
+
+        void SetInfinity(Point& point) const
+        {
+            arithmetic->SetInfinity(point);
+        }
+
+        void Copy(Point& dst, const Point& src) const
+        {
+            arithmetic->Copy(dst, src);
+        }
+
+        bool Import(Point& dst, const EC_POINT* src) const
+        {
+            return arithmetic->Import(dst, group, src, ctx);
+        }
+
+        bool Export(EC_POINT* dst, const Point& src) const
+        {
+            return arithmetic->Export(group, dst, src, ctx);
+        }
+
+        void Double(Point& point) const
+        {
+            arithmetic->Double(point, ctx);
+        }
+
+        void Add(Point& point, const Point& other) const
+        {
+            arithmetic->Add(point, other, ctx);
+        }
+
+        // imported points are already affine
+        void MakeAffine(std::vector<Point>&) const
+        {}
+    };
+
+    size_t Digit(const BIGNUM* k, size_t offset, size_t width)
+    {
+        size_t digit = 0;
+        for (size_t i = 0; i < width; ++i) {
+            digit |= static_cast<size_t>(BN_is_bit_set(k, offset + i)) << i;
+        }
+
+        return digit;
+    }
+
+    size_t MaxBits(const std::vector<const BIGNUM*>& scalars, size_t begin, size_t end)
+    {
+        size_t bits = 0;
+        for (auto i = begin; i < end; ++i) {
+            size_t len = BN_num_bits(scalars[i]);
+            bits = (len > bits) ? len : bits;
+        }
+
+        return bits;
+    }
+
+    // ceil(log2(count)) - 2 balances bucket accumulation against the per-window bucket sums
+    size_t PippengerWindow(size_t count)
+    {
+        size_t log = 0;
+        while ((size_t(1) << log) < count) {
+            log += 1;
+        }
+
+        return (log > 4) ? (log - 2) : 2;
+    }
+
+    template <typename Field>
+    bool StrausRange(const Field& field, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t begin, size_t end)
+    {
+        const size_t width = MultiScalar::STRAUS_WINDOW;
+        const size_t entries = (size_t(1) << width) - 1;
+        auto count = end - begin;
+
+        // table[i * entries + (d - 1)] = d * P_i
+        auto table = field.Allocate(count * entries);
+        for (size_t i = 0; i < count; ++i) {
+            auto row = i * entries;
+            if (!field.Import(table[row], points[begin + i])) {
+                return false;
+            }
+
+            for (size_t d = 1; d < entries; ++d) {
+                field.Copy(table[row + d], table[row + d - 1]);
+                field.Add(table[row + d], table[row]);
+            }
+        }
+        field.MakeAffine(table);
+
+        auto windows = (MaxBits(scalars, begin, end) + width - 1) / width;
+        auto acc = field.Allocate(1);
+        field.SetInfinity(acc[0]);
+
+        for (auto window = windows; window-- > 0;) {
+            for (size_t j = 0; j < width; ++j) {
+                field.Double(acc[0]);
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                auto digit = Digit(scalars[begin + i], window * width, width);
+                if (digit != 0) {
+                    field.Add(acc[0], table[i * entries + digit - 1]);
+                }
+            }
+        }
+
+        return field.Export(result, acc[0]);
+    }
+
+    template <typename Field>
+    bool PippengerRange(const Field& field, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t begin, size_t end)
+    {
+        auto count = end - begin;
+        auto width = PippengerWindow(count);
+
+        auto inputs = field.Allocate(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!field.Import(inputs[i], points[begin + i])) {
+                return false;
+            }
+        }
+        field.MakeAffine(inputs);
+
+        auto buckets = field.Allocate((size_t(1) << width) - 1);
+        auto used = std::vector<bool>(buckets.size());
+        auto acc = field.Allocate(3);
+        auto& total = acc[0];
+        auto& running = acc[1];
+        auto& windowSum = acc[2];
+        field.SetInfinity(total);
+
+        auto windows = (MaxBits(scalars, begin, end) + width - 1) / width;
+        for (auto window = windows; window-- > 0;) {
+            for (size_t j = 0; j < width; ++j) {
+                field.Double(total);
+            }
+
+            std::fill(used.begin(), used.end(), false);
+            for (size_t i = 0; i < count; ++i) {
+                auto digit = Digit(scalars[begin + i], window * width, width);
+                if (digit == 0) {
+                    continue;
+                }
+
+                if (used[digit - 1]) {
+                    field.Add(buckets[digit - 1], inputs[i]);
+                } else {
+                    field.Copy(buckets[digit - 1], inputs[i]);
+                    used[digit - 1] = true;
+                }
+            }
+
+            // sum(d * bucket[d]) as a running sum from the top bucket down
+            field.SetInfinity(running);
+            field.SetInfinity(windowSum);
+            for (auto d = buckets.size(); d-- > 0;) {
+                if (used[d]) {
+                    field.Add(running, buckets[d]);
+                }
+                field.Add(windowSum, running);
+            }
+
+            field.Add(total, windowSum);
+        }
+
+        return field.Export(result, total);
+    }
+
+    template <typename Field>
+    bool Dispatch(const EC_GROUP* group, const LopezDahab* arithmetic, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t begin, size_t end, bool straus)
+    {
+        Field field(group, BNContext::Get(), arithmetic);
+
+        if (straus) {
+            return StrausRange(field, result, scalars, points, begin, end);
+        }
+
+        return PippengerRange(field, result, scalars, points, begin, end);
+    }
+
+    // arithmetic is null exactly for prime fields, see Arithmetic
+    bool Range(const EC_GROUP* group, const LopezDahab* arithmetic, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t begin, size_t end, bool straus)
+    {
+        if (arithmetic != nullptr) {
+            return Dispatch<BinaryField>(group, arithmetic, result, scalars, points, begin, end, straus);
+        }
+
+        return Dispatch<PrimeField>(group, arithmetic, result, scalars, points, begin, end, straus);
+    }
+
+    // the caller's arithmetic, or one built for this call when a binary field group comes without it
+    const LopezDahab* Arithmetic(const EC_GROUP* group, const LopezDahab* arithmetic, std::unique_ptr<LopezDahab>& owned)
+    {
+        if ((arithmetic == nullptr) && (EC_GROUP_get_field_type(group) == NID_X9_62_characteristic_two_field)) {
+            owned = std::unique_ptr<LopezDahab>(new LopezDahab(group));
+            return owned.get();
+        }
+
+        return arithmetic;
+    }
+
+    // reduces every scalar into [0, order * cofactor) so that the windows cover a fixed bit length.
+    // the order alone is not enough: on cofactor curves a valid point outside the prime-order subgroup
+    // is only annihilated by the full group order. when OpenSSL could not determine the cofactor,
+    // non-negative scalars are used as they are and the windows follow their length
+    std::vector<BigNum> ReduceScalars(const EC_GROUP* group, const std::vector<const BIGNUM*>& scalars)
+    {
+        auto ctx = BNContext::Get();
+        auto cofactor = EC_GROUP_get0_cofactor(group);
+        auto cardinality = BigNum(BN_new());
+        if ((cofactor != nullptr) && !BN_is_zero(cofactor)) {
+            if (1 != BN_mul(cardinality.RawPtr(), EC_GROUP_get0_order(group), cofactor, ctx)) {
+                throw std::runtime_error("MultiScalar: BN_mul failed");
+            }
+        }
+
+        std::vector<BigNum> reduced;
+        reduced.reserve(scalars.size());
+        for (auto scalar : scalars) {
+            if (BN_is_zero(cardinality.RawPtr())) {
+                if (BN_is_negative(scalar)) {
+                    throw std::invalid_argument("MultiScalar: negative scalar on a curve with unknown cofactor");
+                }
+                reduced.push_back(BigNum(BN_dup(scalar)));
+                continue;
+            }
+
+            reduced.push_back(BigNum(BN_new()));
+            if (1 != BN_nnmod(reduced.back().RawPtr(), scalar, cardinality.RawPtr(), ctx)) {
+                throw std::runtime_error("MultiScalar: BN_nnmod failed");
+            }
+        }
+
+        return reduced;
+    }
+
+    std::vector<const BIGNUM*> RawScalars(const std::vector<BigNum>& scalars)
+    {
+        std::vector<const BIGNUM*> raw;
+        raw.reserve(scalars.size());
+        for (auto& scalar : scalars) {
+            raw.push_back(scalar.RawPtr());
+        }
+
+        return raw;
+    }
+}
+
+bool MultiScalar::Multiply(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t threads, const LopezDahab* arithmetic)
+{
+    if (scalars.size() < STRAUS_THRESHOLD) {
+        return Straus(group, result, scalars, points, arithmetic);
+    }
+
+    return Pippenger(group, result, scalars, points, threads, arithmetic);
+}
+
+bool MultiScalar::Straus(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, const LopezDahab* arithmetic)
+{
+    if (scalars.size() != points.size()) {
+        throw std::invalid_argument("MultiScalar: number of scalars and points mismatch");
+    }
+
+    std::unique_ptr<LopezDahab> owned;
+    arithmetic = Arithmetic(group, arithmetic, owned);
+
+    auto reduced = ReduceScalars(group, scalars);
+    return Range(group, arithmetic, result, RawScalars(reduced), points, 0, points.size(), true);
+}
+
+bool MultiScalar::Pippenger(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t threads, const LopezDahab* arithmetic)
+{
+    if (scalars.size() != points.size()) {
+        throw std::invalid_argument("MultiScalar: number of scalars and points mismatch");
+    }
+
+    std::unique_ptr<LopezDahab> owned;
+    arithmetic = Arithmetic(group, arithmetic, owned);
+
+    auto reduced = ReduceScalars(group, scalars);
+    auto raw = RawScalars(reduced);
+
+    // each thread takes a contiguous slice of the terms and the partial sums are added at the end
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > points.size() / STRAUS_THRESHOLD) {
+        threads = points.size() / STRAUS_THRESHOLD;
+    }
+
+    if (threads <= 1) {
+        return Range(group, arithmetic, result, raw, points, 0, points.size(), false);
+    }
+
+    std::vector<PrimePoint> partials;
+    partials.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        partials.emplace_back(group);
+    }
+
+    auto success = std::vector<char>(threads, 0);
+    ParallelFor(threads, threads, [&](size_t first, size_t last) {
+        for (auto t = first; t < last; ++t) {
+            auto begin = points.size() * t / threads;
+            auto end = points.size() * (t + 1) / threads;
+            success[t] = Range(group, arithmetic, partials[t].raw, raw, points, begin, end, false);
+        }
+    });
+
+    auto ctx = BNContext::Get();
+    EC_POINT_set_to_infinity(group, result);
+    for (size_t t = 0; t < threads; ++t) {
+        if (!success[t] || (1 != EC_POINT_add(group, result, result, partials[t].raw, ctx))) {
+            return false;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
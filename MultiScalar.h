@@ -0,0 +1,56 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_MULTI_SCALAR_H__
+#define __ECC_MULTI_SCALAR_H__
+
+#include "LopezDahab.h"
+
+#include <openssl/ec.h>
+#include <openssl/bn.h>
+#include <vector>
+
+namespace ecc
+{
+    // MultiScalar : computes sum(k_i * P_i) without a full scalar multiplication per term
+    //
+    // small inputs use interleaved fixed-window Straus (one shared doubling chain, a 4-bit table per point),
+    // large inputs use bucket-based Pippenger, optionally split across threads.
+    // binary fields run in Lopez-Dahab projective coordinates, with the group's cached LopezDahab when
+    // the caller passes one (see ECGroup::Arithmetic) and a fresh one per call otherwise.
+    class MultiScalar
+    {
+    public:
+        static const size_t STRAUS_THRESHOLD;
+        static const size_t STRAUS_WINDOW;
+
+    public:
+        static bool Multiply(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t threads, const LopezDahab* arithmetic = nullptr);
+
+        static bool Straus(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, const LopezDahab* arithmetic = nullptr);
+        static bool Pippenger(const EC_GROUP* group, EC_POINT* result, const std::vector<const BIGNUM*>& scalars, const std::vector<const EC_POINT*>& points, size_t threads, const LopezDahab* arithmetic = nullptr);
+    };
+}
+
+#endif
\ No newline at end of file
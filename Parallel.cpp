@@ -0,0 +1,108 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Parallel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+using namespace ecc;
+
+namespace
+{
+    // more ranges than threads, so that a thread finishing early keeps taking work
+    const size_t RANGES_PER_THREAD = 4;
+
+    struct Batch {
+        const std::function<void(size_t, size_t)>* body;
+        size_t count;
+        size_t ranges;
+
+        std::atomic<size_t> claimed;
+        std::atomic<size_t> remaining;
+
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+
+        Batch(const std::function<void(size_t, size_t)>& body, size_t count, size_t ranges) : body(&body), count(count), ranges(ranges), claimed(0), remaining(ranges)
+        {}
+
+        // runs ranges until none are left to claim; the body is only touched while a claimed range keeps the caller waiting
+        void Drain()
+        {
+            for (auto idx = claimed++; idx < ranges; idx = claimed++) {
+                try {
+                    (*body)(count * idx / ranges, count * (idx + 1) / ranges);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (error == nullptr) {
+                        error = std::current_exception();
+                    }
+                }
+
+                if (--remaining == 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.notify_all();
+                }
+            }
+        }
+    };
+}
+
+void ecc::ParallelFor(size_t count, size_t threads, const std::function<void(size_t, size_t)>& body)
+{
+    if (threads > count) {
+        threads = count;
+    }
+
+    if (threads <= 1) {
+        if (count > 0) {
+            body(0, count);
+        }
+        return;
+    }
+
+    auto ranges = std::min(count, threads * RANGES_PER_THREAD);
+    auto batch = std::make_shared<Batch>(body, count, ranges);
+
+    // the caller drains as well, so nested calls from pool workers never wait on unclaimed ranges
+    auto& pool = ThreadPool::Shared();
+    for (size_t i = 1; i < threads; ++i) {
+        pool.Submit([batch]() { batch->Drain(); });
+    }
+    batch->Drain();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&]() { return batch->remaining == 0; });
+
+    if (batch->error != nullptr) {
+        std::rethrow_exception(batch->error);
+    }
+}
\ No newline at end of file
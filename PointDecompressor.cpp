@@ -0,0 +1,558 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PointDecompressor.h"
+#include "GF2Modulus.h"
+#include "BNContext.h"
+#include "ScratchArena.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <openssl/obj_mac.h>
+
+using namespace ecc;
+
+namespace
+{
+    bool IsCompressed(const uint8_t* src)
+    {
+        return (src[0] == 0x02) || (src[0] == 0x03);
+    }
+
+    // uncompressed 0x04, or hybrid 0x06 / 0x07 which carries the y bit next to both coordinates
+    bool IsUncompressed(const uint8_t* src)
+    {
+        return (src[0] == 0x04) || (src[0] == 0x06) || (src[0] == 0x07);
+    }
+
+    void ToWords(const BIGNUM* num, uint64_t* words, size_t count, uint8_t* bytes)
+    {
+        BN_bn2lebinpad(num, bytes, count << 3);
+        for (size_t w = 0; w < count; ++w) {
+            uint64_t word = 0;
+            for (size_t k = 0; k < 8; ++k) {
+                word |= static_cast<uint64_t>(bytes[(w << 3) + k]) << (k << 3);
+            }
+            words[w] = word;
+        }
+    }
+
+    void FromWords(BIGNUM* num, const uint64_t* words, size_t count, uint8_t* bytes)
+    {
+        for (size_t w = 0; w < count; ++w) {
+            for (size_t k = 0; k < 8; ++k) {
+                bytes[(w << 3) + k] = static_cast<uint8_t>(words[w] >> (k << 3));
+            }
+        }
+        BN_lebin2bn(bytes, count << 3, num);
+    }
+}
+
+PointDecompressor::PointDecompressor(const EC_GROUP* group) : binaryField(EC_GROUP_get_field_type(group) == NID_X9_62_characteristic_two_field), degree(EC_GROUP_get_degree(group)), p(BN_new()), a(BN_new()), b(BN_new()), fastSqrt(false), sqrtExponent(BN_new()), sqrtB(BN_new())
+{
+    auto ctx = BNContext::Get();
+    EC_GROUP_get_curve(group, p.RawPtr(), a.RawPtr(), b.RawPtr(), ctx);
+
+    if (!binaryField) {
+        // p = 3 mod 4: sqrt(c) = c^((p + 1) / 4)
+        fastSqrt = BN_is_bit_set(p.RawPtr(), 0) && BN_is_bit_set(p.RawPtr(), 1);
+        if (fastSqrt) {
+            BN_copy(sqrtExponent.RawPtr(), p.RawPtr());
+            BN_add_word(sqrtExponent.RawPtr(), 1);
+            BN_rshift(sqrtExponent.RawPtr(), sqrtExponent.RawPtr(), 2);
+
+            mont = std::shared_ptr<BN_MONT_CTX>(BN_MONT_CTX_new(), BN_MONT_CTX_free);
+            if ((mont == nullptr) || (1 != BN_MONT_CTX_set(mont.get(), p.RawPtr(), ctx))) {
+                throw std::runtime_error("PointDecompressor: BN_MONT_CTX_set failed");
+            }
+        }
+        return;
+    }
+
+    // trinomial or pentanomial, plus the terminating -1 counted by BN_GF2m_poly2arr
+    irreducible = std::vector<int>(6, -1);
+    auto terms = BN_GF2m_poly2arr(p.RawPtr(), irreducible.data(), irreducible.size());
+    if ((terms == 0) || (terms > static_cast<int>(irreducible.size()))) {
+        throw std::invalid_argument("PointDecompressor: irreducible polynomial has too many terms");
+    }
+
+    // y of the point with x = 0
+    BN_GF2m_mod_sqrt_arr(sqrtB.RawPtr(), b.RawPtr(), irreducible.data(), ctx);
+
+    if ((degree & 1) == 0) {
+        return;
+    }
+
+    // row i is H(x^i) = sum of x^(i * 4^k) for k <= (m - 1) / 2. H commutes with squaring, so every
+    // even row past the first is the square of an earlier one and only the odd rows are summed out
+    auto modulus = GF2Modulus(GF2Polynomial(p));
+    auto rows = std::vector<GF2Polynomial>(degree);
+    halfTrace = GF2Matrix(degree, degree);
+    traceMask = std::vector<uint64_t>((degree + 63) >> 6);
+
+    for (size_t i = 0; i < degree; ++i) {
+        if ((i != 0) && ((i & 1) == 0)) {
+            rows[i] = modulus.Square(rows[i >> 1]);
+        } else {
+            auto power = GF2Polynomial(degree);
+            power.SetBit(i);
+
+            rows[i] = power;
+            for (size_t k = 0; k < (degree - 1) / 2; ++k) {
+                power = modulus.Square(modulus.Square(power));
+                rows[i] ^= power;
+            }
+        }
+
+        halfTrace.SetRow(i, rows[i].Words());
+
+        // H(c)^2 + H(c) = c + Tr(c), which gives the trace of every x^i for free
+        auto power = GF2Polynomial(degree);
+        power.SetBit(i);
+
+        auto trace = modulus.Square(rows[i]);
+        trace ^= rows[i];
+        trace ^= power;
+        if (!trace.IsZero()) {
+            traceMask[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3f);
+        }
+    }
+
+    halfTrace.Precompute();
+}
+
+size_t PointDecompressor::Decompress(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const
+{
+    if (binaryField) {
+        return (halfTrace.Rows() != 0) ? DecompressGF2m(group, data, count, points, ctx) : DecompressEach(group, data, count, points, ctx);
+    }
+
+    return fastSqrt ? DecompressGFp(group, data, count, points, ctx) : DecompressEach(group, data, count, points, ctx);
+}
+
+size_t PointDecompressor::DecompressGFp(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const
+{
+    auto fieldBytes = (degree + 7) >> 3;
+    auto stride = fieldBytes + 1;
+
+    BN_CTX_start(ctx);
+    auto x = BN_CTX_get(ctx);
+    auto y = BN_CTX_get(ctx);
+    auto rhs = BN_CTX_get(ctx);
+    auto t = BN_CTX_get(ctx);
+    if (t == nullptr) {
+        BN_CTX_end(ctx);
+        throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+    }
+
+    size_t i = 0;
+    for (; i < count; ++i) {
+        auto src = data + i * stride;
+        if (!IsCompressed(src)) {
+            break;
+        }
+
+        BN_bin2bn(src + 1, fieldBytes, x);
+        if (BN_cmp(x, p.RawPtr()) >= 0) {
+            break;
+        }
+
+        // y^2 = (x^2 + a) * x + b
+        BN_mod_sqr(rhs, x, p.RawPtr(), ctx);
+        BN_mod_add(rhs, rhs, a.RawPtr(), p.RawPtr(), ctx);
+        BN_mod_mul(rhs, rhs, x, p.RawPtr(), ctx);
+        BN_mod_add(rhs, rhs, b.RawPtr(), p.RawPtr(), ctx);
+
+        BN_mod_exp_mont(y, rhs, sqrtExponent.RawPtr(), p.RawPtr(), ctx, mont.get());
+        BN_mod_sqr(t, y, p.RawPtr(), ctx);
+        if (BN_cmp(t, rhs) != 0) {
+            break;
+        }
+
+        if (BN_is_odd(y) != (src[0] & 0x1)) {
+            if (BN_is_zero(y)) {
+                break;
+            }
+            BN_usub(y, p.RawPtr(), y);
+        }
+
+        if (1 != EC_POINT_set_affine_coordinates(group, points[i], x, y, ctx)) {
+            break;
+        }
+    }
+
+    BN_CTX_end(ctx);
+    return i;
+}
+
+// with x != 0 and y = x * z the curve equation becomes z^2 + z = c, c = x + a + b / x^2,
+// which has a solution iff Tr(c) = 0, and then z = H(c) or H(c) + 1 by the low bit
+size_t PointDecompressor::DecompressGF2m(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const
+{
+    const size_t block = 256;
+
+    auto fieldBytes = (degree + 7) >> 3;
+    auto stride = fieldBytes + 1;
+    auto words = (degree + 63) >> 6;
+    auto arr = irreducible.data();
+
+    auto xs = std::vector<BIGNUM*>(std::min(count, block));
+    auto cs = std::vector<BIGNUM*>(xs.size());
+    auto vectors = ScratchVector<uint64_t>(xs.size() * words);
+    auto results = ScratchVector<uint64_t>(vectors.size());
+    auto bytes = ScratchVector<uint8_t>(words << 3);
+
+    for (size_t first = 0; first < count; first += block) {
+        auto n = std::min(block, count - first);
+
+        BN_CTX_start(ctx);
+        auto acc = BN_CTX_get(ctx);
+        auto t = BN_CTX_get(ctx);
+        auto y = BN_CTX_get(ctx);
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = BN_CTX_get(ctx);
+            cs[i] = BN_CTX_get(ctx);
+        }
+
+        if (cs[n - 1] == nullptr) {
+            BN_CTX_end(ctx);
+            throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+        }
+
+        // the block stops short at the first malformed point
+        size_t valid = 0;
+        for (; valid < n; ++valid) {
+            auto src = data + (first + valid) * stride;
+            if (!IsCompressed(src)) {
+                break;
+            }
+
+            BN_bin2bn(src + 1, fieldBytes, xs[valid]);
+            if (static_cast<size_t>(BN_num_bits(xs[valid])) > degree) {
+                break;
+            }
+        }
+
+        CurveTerms(xs.data(), cs.data(), valid, ctx);
+        for (size_t i = 0; i < valid; ++i) {
+            if (!BN_is_zero(xs[i])) {
+                ToWords(cs[i], &vectors[i * words], words, bytes.data());
+            }
+        }
+
+        halfTrace.Multiply(vectors.data(), results.data(), valid);
+
+        size_t done = 0;
+        for (; done < valid; ++done) {
+            auto x = xs[done];
+            auto ybit = data[(first + done) * stride] & 0x1;
+
+            // SEC 1 takes y = sqrt(b) for x = 0 whatever the y bit says
+            if (BN_is_zero(x)) {
+                BN_copy(y, sqrtB.RawPtr());
+            } else {
+                FromWords(t, &results[done * words], words, bytes.data());
+
+                BN_GF2m_mod_sqr_arr(acc, t, arr, ctx);
+                BN_GF2m_add(acc, acc, t);
+                if (BN_cmp(acc, cs[done]) != 0) {
+                    break;
+                }
+
+                if (BN_is_bit_set(t, 0) != ybit) {
+                    BN_GF2m_add(t, t, BN_value_one());
+                }
+                BN_GF2m_mod_mul_arr(y, x, t, arr, ctx);
+            }
+
+            if (1 != EC_POINT_set_affine_coordinates(group, points[first + done], x, y, ctx)) {
+                break;
+            }
+        }
+
+        BN_CTX_end(ctx);
+
+        if (done < n) {
+            return first + done;
+        }
+    }
+
+    return count;
+}
+
+// cs[i] = x_i + a + b / x_i^2 for every nonzero x_i, with the inverses out of one inversion
+// (Montgomery's trick); cs[i] of a zero x_i is left untouched
+void PointDecompressor::CurveTerms(BIGNUM* const* xs, BIGNUM* const* cs, size_t count, BN_CTX* ctx) const
+{
+    auto arr = irreducible.data();
+
+    BN_CTX_start(ctx);
+    auto acc = BN_CTX_get(ctx);
+    auto t = BN_CTX_get(ctx);
+    auto u = BN_CTX_get(ctx);
+    if (u == nullptr) {
+        BN_CTX_end(ctx);
+        throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+    }
+
+    // cs[i] holds the running product of the nonzero x^2 first
+    BN_one(acc);
+    for (size_t i = 0; i < count; ++i) {
+        if (!BN_is_zero(xs[i])) {
+            BN_GF2m_mod_sqr_arr(t, xs[i], arr, ctx);
+            BN_GF2m_mod_mul_arr(acc, acc, t, arr, ctx);
+        }
+        BN_copy(cs[i], acc);
+    }
+
+    BN_GF2m_mod_inv_arr(acc, acc, arr, ctx);
+
+    for (size_t i = count; i-- > 0;) {
+        if (BN_is_zero(xs[i])) {
+            continue;
+        }
+
+        // acc holds (x_0^2 ... x_i^2)^-1 here
+        if (i > 0) {
+            BN_GF2m_mod_mul_arr(t, acc, cs[i - 1], arr, ctx);
+        } else {
+            BN_copy(t, acc);
+        }
+        BN_GF2m_mod_sqr_arr(u, xs[i], arr, ctx);
+        BN_GF2m_mod_mul_arr(acc, acc, u, arr, ctx);
+
+        BN_GF2m_mod_mul_arr(t, t, b.RawPtr(), arr, ctx);
+        BN_GF2m_add(t, t, a.RawPtr());
+        BN_GF2m_add(cs[i], t, xs[i]);
+    }
+
+    BN_CTX_end(ctx);
+}
+
+size_t PointDecompressor::DecompressEach(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const
+{
+    auto stride = ((degree + 7) >> 3) + 1;
+
+    size_t i = 0;
+    for (; i < count; ++i) {
+        if (1 != EC_POINT_oct2point(group, points[i], data + i * stride, stride, ctx)) {
+            break;
+        }
+    }
+
+    return i;
+}
+void PointDecompressor::Validate(const uint8_t* data, size_t count, bool compressed, uint64_t* bitmap, BN_CTX* ctx) const
+{
+    if (!compressed) {
+        ValidateUncompressed(data, count, bitmap, ctx);
+    } else if (binaryField) {
+        ValidateCompressedGF2m(data, count, bitmap, ctx);
+    } else {
+        ValidateCompressedGFp(data, count, bitmap, ctx);
+    }
+}
+
+// y^2 = (x^2 + a) * x + b over a prime field, y^2 + xy = (x + a) * x^2 + b over a binary one.
+// a hybrid encoding must also carry the y bit of the point, as oct2point requires
+void PointDecompressor::ValidateUncompressed(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const
+{
+    auto fieldBytes = (degree + 7) >> 3;
+    auto stride = 2 * fieldBytes + 1;
+    auto arr = irreducible.data();
+
+    BN_CTX_start(ctx);
+    auto x = BN_CTX_get(ctx);
+    auto y = BN_CTX_get(ctx);
+    auto lhs = BN_CTX_get(ctx);
+    auto rhs = BN_CTX_get(ctx);
+    if (rhs == nullptr) {
+        BN_CTX_end(ctx);
+        throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        auto src = data + i * stride;
+        if (!IsUncompressed(src)) {
+            continue;
+        }
+
+        auto hybrid = src[0] != 0x04;
+        auto ybit = src[0] & 0x1;
+
+        BN_bin2bn(src + 1, fieldBytes, x);
+        BN_bin2bn(src + 1 + fieldBytes, fieldBytes, y);
+
+        if (binaryField) {
+            if ((static_cast<size_t>(BN_num_bits(x)) > degree) || (static_cast<size_t>(BN_num_bits(y)) > degree)) {
+                continue;
+            }
+
+            // the y bit is the low bit of y / x, which does not exist for x = 0
+            if (hybrid && (BN_is_zero(x) || (1 != BN_GF2m_mod_div(lhs, y, x, p.RawPtr(), ctx)) || (BN_is_odd(lhs) != ybit))) {
+                continue;
+            }
+
+            BN_GF2m_add(lhs, x, y);
+            BN_GF2m_mod_mul_arr(lhs, lhs, y, arr, ctx);
+            BN_GF2m_mod_sqr_arr(rhs, x, arr, ctx);
+            BN_GF2m_add(y, x, a.RawPtr());
+            BN_GF2m_mod_mul_arr(rhs, rhs, y, arr, ctx);
+            BN_GF2m_add(rhs, rhs, b.RawPtr());
+        } else {
+            if ((BN_cmp(x, p.RawPtr()) >= 0) || (BN_cmp(y, p.RawPtr()) >= 0)) {
+                continue;
+            }
+
+            if (hybrid && (BN_is_odd(y) != ybit)) {
+                continue;
+            }
+
+            BN_mod_sqr(lhs, y, p.RawPtr(), ctx);
+            BN_mod_sqr(rhs, x, p.RawPtr(), ctx);
+            BN_mod_add(rhs, rhs, a.RawPtr(), p.RawPtr(), ctx);
+            BN_mod_mul(rhs, rhs, x, p.RawPtr(), ctx);
+            BN_mod_add(rhs, rhs, b.RawPtr(), p.RawPtr(), ctx);
+        }
+
+        if (BN_cmp(lhs, rhs) == 0) {
+            bitmap[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3f);
+        }
+    }
+
+    BN_CTX_end(ctx);
+}
+
+// a compressed point exists iff x^3 + ax + b is a square, which the Kronecker symbol tells
+// without the exponentiation a square root would take
+void PointDecompressor::ValidateCompressedGFp(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const
+{
+    auto fieldBytes = (degree + 7) >> 3;
+    auto stride = fieldBytes + 1;
+
+    BN_CTX_start(ctx);
+    auto x = BN_CTX_get(ctx);
+    auto rhs = BN_CTX_get(ctx);
+    if (rhs == nullptr) {
+        BN_CTX_end(ctx);
+        throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        auto src = data + i * stride;
+        if (!IsCompressed(src)) {
+            continue;
+        }
+
+        BN_bin2bn(src + 1, fieldBytes, x);
+        if (BN_cmp(x, p.RawPtr()) >= 0) {
+            continue;
+        }
+
+        BN_mod_sqr(rhs, x, p.RawPtr(), ctx);
+        BN_mod_add(rhs, rhs, a.RawPtr(), p.RawPtr(), ctx);
+        BN_mod_mul(rhs, rhs, x, p.RawPtr(), ctx);
+        BN_mod_add(rhs, rhs, b.RawPtr(), p.RawPtr(), ctx);
+
+        // a zero right hand side means y = 0, which only an even y bit can name
+        if (BN_is_zero(rhs) ? ((src[0] & 0x1) == 0) : (BN_kronecker(rhs, p.RawPtr(), ctx) == 1)) {
+            bitmap[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3f);
+        }
+    }
+
+    BN_CTX_end(ctx);
+}
+
+// z^2 + z = c has a solution iff Tr(c) = 0, and the trace is the parity of c under traceMask
+void PointDecompressor::ValidateCompressedGF2m(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const
+{
+    const size_t block = 256;
+
+    auto fieldBytes = (degree + 7) >> 3;
+    auto stride = fieldBytes + 1;
+    auto words = (degree + 63) >> 6;
+    auto arr = irreducible.data();
+
+    auto xs = std::vector<BIGNUM*>(std::min(count, block));
+    auto cs = std::vector<BIGNUM*>(xs.size());
+    auto parsed = ScratchVector<uint8_t>(xs.size());
+    auto vector = ScratchVector<uint64_t>(words);
+    auto bytes = ScratchVector<uint8_t>(words << 3);
+
+    for (size_t first = 0; first < count; first += block) {
+        auto n = std::min(block, count - first);
+
+        BN_CTX_start(ctx);
+        auto z = BN_CTX_get(ctx);
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = BN_CTX_get(ctx);
+            cs[i] = BN_CTX_get(ctx);
+        }
+
+        if (cs[n - 1] == nullptr) {
+            BN_CTX_end(ctx);
+            throw std::runtime_error("PointDecompressor: BN_CTX_get failed");
+        }
+
+        // malformed entries are zeroed so that they stay out of the shared inversion
+        for (size_t i = 0; i < n; ++i) {
+            auto src = data + (first + i) * stride;
+            BN_bin2bn(src + 1, fieldBytes, xs[i]);
+
+            parsed[i] = IsCompressed(src) && (static_cast<size_t>(BN_num_bits(xs[i])) <= degree);
+            if (!parsed[i]) {
+                BN_zero(xs[i]);
+            }
+        }
+
+        CurveTerms(xs.data(), cs.data(), n, ctx);
+
+        if (traceMask.empty()) {
+            for (size_t i = 0; i < n; ++i) {
+                if (parsed[i] && (BN_is_zero(xs[i]) || (1 == BN_GF2m_mod_solve_quad_arr(z, cs[i], arr, ctx)))) {
+                    bitmap[(first + i) >> 6] |= static_cast<uint64_t>(1) << ((first + i) & 0x3f);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                auto valid = parsed[i] != 0;
+                if (valid && !BN_is_zero(xs[i])) {
+                    ToWords(cs[i], vector.data(), words, bytes.data());
+
+                    uint64_t parity = 0;
+                    for (size_t w = 0; w < words; ++w) {
+                        parity ^= vector[w] & traceMask[w];
+                    }
+                    valid = (__builtin_parityll(parity) == 0);
+                }
+
+                if (valid) {
+                    bitmap[(first + i) >> 6] |= static_cast<uint64_t>(1) << ((first + i) & 0x3f);
+                }
+            }
+        }
+
+        BN_CTX_end(ctx);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_POINT_DECOMPRESSOR_H__
+#define __ECC_POINT_DECOMPRESSOR_H__
+
+#include "BigNum.h"
+#include "GF2Matrix.h"
+
+#include <openssl/ec.h>
+#include <openssl/bn.h>
+#include <vector>
+#include <memory>
+
+namespace ecc
+{
+    // PointDecompressor : per-curve constants for recovering y from compressed points in bulk,
+    // and for validating encoded points without building them
+    //
+    // prime fields with p = 3 mod 4 take the square root as one exponentiation by (p + 1) / 4 in a
+    // Montgomery context built once. binary fields of odd degree solve z^2 + z = c with the half-trace,
+    // a linear map kept as a GF2Matrix with Four-Russians tables, after the 1 / x^2 of a whole block
+    // comes out of a single inversion. other fields fall back to OpenSSL one point at a time.
+    class PointDecompressor
+    {
+    private:
+        bool binaryField;
+        size_t degree;
+        BigNum p;
+        BigNum a;
+        BigNum b;
+
+        // prime field only
+        bool fastSqrt;
+        BigNum sqrtExponent;
+        std::shared_ptr<BN_MONT_CTX> mont;
+
+        // binary field only
+        std::vector<int> irreducible;
+        BigNum sqrtB;
+        GF2Matrix halfTrace;
+        std::vector<uint64_t> traceMask;
+
+    public:
+        PointDecompressor(const EC_GROUP* group);
+        PointDecompressor(const PointDecompressor& other) = delete;
+        ~PointDecompressor() = default;
+
+        PointDecompressor& operator=(const PointDecompressor& other) = delete;
+
+        // data holds count SEC 1 compressed points back to back. returns count on success,
+        // otherwise the index of the first point that is malformed or not on the curve
+        size_t Decompress(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const;
+
+        // data holds count encodings of EncodedLength(compressed) bytes. sets bit i of bitmap, which the
+        // caller clears, when encoding i is in the expected form and names a point of the curve
+        void Validate(const uint8_t* data, size_t count, bool compressed, uint64_t* bitmap, BN_CTX* ctx) const;
+
+    private:
+        void CurveTerms(BIGNUM* const* xs, BIGNUM* const* cs, size_t count, BN_CTX* ctx) const;
+
+        size_t DecompressGFp(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const;
+        size_t DecompressGF2m(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const;
+        size_t DecompressEach(const EC_GROUP* group, const uint8_t* data, size_t count, EC_POINT** points, BN_CTX* ctx) const;
+
+        void ValidateUncompressed(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const;
+        void ValidateCompressedGFp(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const;
+        void ValidateCompressedGF2m(const uint8_t* data, size_t count, uint64_t* bitmap, BN_CTX* ctx) const;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ScratchArena.h"
+
+#include <algorithm>
+
+using namespace ecc;
+
+const size_t ScratchArena::CHUNK_SIZE;
+
+namespace
+{
+    thread_local ScratchArena* bound = nullptr;
+}
+
+ScratchArena::ScratchArena(size_t chunkSize) : chunkSize(chunkSize), current(0), offset(0)
+{}
+
+// the next chunk large enough is taken when the current one is full; later chunks are only skipped,
+// never freed, so they come back after a rewind
+void* ScratchArena::Allocate(size_t bytes, size_t alignment)
+{
+    if (bytes == 0) {
+        bytes = 1;
+    }
+
+    while (current < chunks.size()) {
+        auto& chunk = chunks[current];
+        auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        auto aligned = (base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        if (aligned + bytes <= base + chunk.size) {
+            offset = aligned + bytes - base;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        ++current;
+        offset = 0;
+    }
+
+    auto size = std::max(chunkSize, bytes + alignment);
+    chunks.push_back(Chunk{ std::unique_ptr<uint8_t[]>(new uint8_t[size]), size });
+    current = chunks.size() - 1;
+    offset = 0;
+
+    return Allocate(bytes, alignment);
+}
+
+// a no-op unless ptr is the block allocated last
+void ScratchArena::Release(void* ptr, size_t bytes)
+{
+    if ((bytes == 0) || (current >= chunks.size())) {
+        return;
+    }
+
+    auto base = chunks[current].data.get();
+    auto block = static_cast<uint8_t*>(ptr);
+    if ((block >= base) && (block + bytes == base + offset)) {
+        offset = block - base;
+    }
+}
+
+ScratchArena::Mark ScratchArena::Position() const
+{
+    return Mark{ current, offset };
+}
+
+void ScratchArena::Rewind(const Mark& mark)
+{
+    current = mark.chunk;
+    offset = mark.offset;
+}
+
+void ScratchArena::Reset()
+{
+    current = 0;
+    offset = 0;
+}
+
+size_t ScratchArena::Capacity() const
+{
+    size_t total = 0;
+    for (auto& chunk : chunks) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+ScratchArena* ScratchArena::Current()
+{
+    return bound;
+}
+
+ScratchArena* ScratchArena::Bind(ScratchArena* arena)
+{
+    auto previous = bound;
+    bound = arena;
+    return previous;
+}
+
+ScratchScope::ScratchScope(ScratchArena& arena) : arena(arena), previous(ScratchArena::Bind(&arena)), mark(arena.Position())
+{}
+
+ScratchScope::~ScratchScope()
+{
+    arena.Rewind(mark);
+    ScratchArena::Bind(previous);
+}
\ No newline at end of file
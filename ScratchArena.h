@@ -0,0 +1,164 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_SCRATCH_ARENA_H__
+#define __ECC_SCRATCH_ARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace ecc
+{
+    // ScratchArena : bump allocator for the temporaries of one request
+    //
+    // memory comes from chunks that are kept across resets, so a warmed up arena allocates nothing.
+    // only the latest block can be released on its own, which keeps nested temporaries flat;
+    // everything else after a mark goes at once when the arena is rewound to it.
+    // an arena is used by one thread at a time, see ScratchScope.
+    class ScratchArena
+    {
+    public:
+        static const size_t CHUNK_SIZE = 64 * 1024;
+
+        struct Mark {
+            size_t chunk;
+            size_t offset;
+        };
+
+    private:
+        struct Chunk {
+            std::unique_ptr<uint8_t[]> data;
+            size_t size;
+        };
+
+        std::vector<Chunk> chunks;
+        size_t chunkSize;
+        size_t current;
+        size_t offset;
+
+    public:
+        explicit ScratchArena(size_t chunkSize = CHUNK_SIZE);
+        ~ScratchArena() = default;
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+        void* Allocate(size_t bytes, size_t alignment);
+        void Release(void* ptr, size_t bytes);
+
+        Mark Position() const;
+        void Rewind(const Mark& mark);
+        void Reset();
+
+        size_t Capacity() const;
+
+        // the arena bound to the calling thread by the innermost ScratchScope, or null
+        static ScratchArena* Current();
+
+    private:
+        friend class ScratchScope;
+        static ScratchArena* Bind(ScratchArena* arena);
+    };
+
+    // ScratchScope : binds an arena to the calling thread until the end of the scope
+    //
+    // on exit the arena is rewound to where the scope found it and the previous binding comes back,
+    // so scratch containers must not outlive the scope they were created in.
+    class ScratchScope
+    {
+    private:
+        ScratchArena& arena;
+        ScratchArena* previous;
+        ScratchArena::Mark mark;
+
+    public:
+        explicit ScratchScope(ScratchArena& arena);
+        ~ScratchScope();
+
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+    };
+
+    // draws from the arena bound when the allocator was made, or from the heap when there is none
+    template <typename T>
+    class ScratchAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef ScratchAllocator<U> other;
+        };
+
+        ScratchArena* arena;
+
+    public:
+        ScratchAllocator() : arena(ScratchArena::Current())
+        {}
+
+        template <typename U>
+        ScratchAllocator(const ScratchAllocator<U>& other) : arena(other.arena)
+        {}
+
+        T* allocate(size_t count)
+        {
+            if (arena != nullptr) {
+                return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+            }
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t count)
+        {
+            if (arena == nullptr) {
+                ::operator delete(ptr);
+            } else {
+                arena->Release(ptr, count * sizeof(T));
+            }
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ScratchAllocator<T>& lhs, const ScratchAllocator<U>& rhs)
+    {
+        return lhs.arena == rhs.arena;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const ScratchAllocator<T>& lhs, const ScratchAllocator<U>& rhs)
+    {
+        return lhs.arena != rhs.arena;
+    }
+
+    // function-local temporaries only; see ScratchScope
+    template <typename T>
+    using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ThreadPool.h"
+
+using namespace ecc;
+
+namespace
+{
+    // set on pool workers, so that nested submissions stay on the submitting worker
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads) : pending(0), next(0), stopping(false)
+{
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        queues.emplace_back(new Queue());
+    }
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::Run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::Size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    auto index = (currentPool == this) ? currentIndex : (next++ % queues.size());
+
+    // counted before it is visible, so that a worker taking it at once never drives pending below zero
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wakeup.notify_one();
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
+
+void ThreadPool::Run(size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (Pop(index, task) || Steal(index, task)) {
+            --pending;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeup.wait(lock, [this]() { return stopping || (pending > 0); });
+        if (stopping && (pending == 0)) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::Pop(size_t index, std::function<void()>& task)
+{
+    auto& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::Steal(size_t index, std::function<void()>& task)
+{
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto& queue = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ECC_THREAD_POOL_H__
+#define __ECC_THREAD_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecc
+{
+    // ThreadPool : fixed set of workers, each owning a task deque
+    //
+    // a worker pops the newest task from its own deque and, when that is empty, steals the oldest task
+    // from the others. tasks submitted from a worker go to that worker's deque, others are spread round robin.
+    // tasks must not throw; ParallelFor is the usual way in and forwards exceptions to its caller.
+    class ThreadPool
+    {
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::atomic<size_t> pending;
+        std::atomic<size_t> next;
+        bool stopping;
+
+    public:
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t Size() const;
+        void Submit(std::function<void()> task);
+
+        // process-wide pool with one worker per hardware thread, started on first use
+        static ThreadPool& Shared();
+
+    private:
+        void Run(size_t index);
+        bool Pop(size_t index, std::function<void()>& task);
+        bool Steal(size_t index, std::function<void()>& task);
+    };
+}
+
+#endif
\ No newline at end of file
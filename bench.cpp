@@ -0,0 +1,332 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CurveRegistry.h"
+#include "BasisConversion.h"
+#include "GF2Polynomial.h"
+#include "GF2Matrix.h"
+#include "BNContext.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <openssl/crypto.h>
+#include <openssl/opensslv.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ECC_BENCH_HAS_TSC 1
+#endif
+
+#ifndef ECC_BENCH_COMMIT
+#define ECC_BENCH_COMMIT "unknown"
+#endif
+
+using namespace ecc;
+
+// allocation counters: every operator new in the process and every OpenSSL allocation
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+static void* countedMalloc(size_t size, const char*, int)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+static void* countedRealloc(void* ptr, size_t size, const char*, int)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::realloc(ptr, size);
+}
+
+static void countedFree(void* ptr, const char*, int)
+{
+    std::free(ptr);
+}
+
+static uint64_t ticks()
+{
+#if defined(ECC_BENCH_HAS_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// fixed xorshift stream, so every run and every commit measures the same inputs
+static uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+static std::vector<uint8_t> randomBytes(size_t length)
+{
+    auto bytes = std::vector<uint8_t>(length);
+    for (auto& byte : bytes) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        byte = static_cast<uint8_t>(seed >> 56);
+    }
+    return bytes;
+}
+
+// ops whose result is a plain value store it here, so that the call is neither dropped nor warned about
+static volatile bool sink = false;
+
+static BigNum randomBelow(const BigNum& bound)
+{
+    auto value = BigNum(randomBytes((bound.BitLength() + 7) / 8 + 8));
+    return value % bound;
+}
+
+class Bench
+{
+private:
+    // a repetition runs at least this long; the median of REPETITIONS is reported
+    static const size_t MIN_NS = 20 * 1000 * 1000;
+    static const size_t REPETITIONS = 5;
+
+    std::string filter;
+    bool first;
+
+public:
+    Bench(const std::string& filter) : filter(filter), first(true)
+    {}
+
+    // op runs `batch` operations per call, so batch APIs report per element
+    template <typename Op>
+    void Run(const std::string& name, const std::string& curve, size_t bits, Op op, size_t batch = 1)
+    {
+        if (!filter.empty() && (name.find(filter) == std::string::npos) && (curve.find(filter) == std::string::npos)) {
+            return;
+        }
+
+        op();
+
+        size_t iterations = 1;
+        while (true) {
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                op();
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+            if (static_cast<size_t>(elapsed) >= MIN_NS / 4) {
+                iterations = std::max<size_t>(1, iterations * MIN_NS / std::max<size_t>(1, elapsed));
+                break;
+            }
+            iterations *= 4;
+        }
+
+        auto ns = std::vector<double>();
+        auto cycles = std::vector<double>();
+        auto allocs = std::vector<double>();
+        for (size_t r = 0; r < REPETITIONS; ++r) {
+            auto count = allocations.load();
+            auto tsc = ticks();
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                op();
+            }
+            auto end = std::chrono::steady_clock::now();
+            tsc = ticks() - tsc;
+            count = allocations.load() - count;
+
+            auto ops = static_cast<double>(iterations * batch);
+            ns.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / ops);
+            cycles.push_back(tsc / ops);
+            allocs.push_back(count / ops);
+        }
+
+        std::sort(ns.begin(), ns.end());
+        std::sort(cycles.begin(), cycles.end());
+        std::sort(allocs.begin(), allocs.end());
+
+        char line[512];
+        snprintf(line, sizeof(line), "%s\n    {\"op\": \"%s\", \"curve\": \"%s\", \"bits\": %zu, \"iterations\": %zu, \"ns_per_op\": %.1f, \"cycles_per_op\": %.0f, \"allocs_per_op\": %.2f}",
+            first ? "" : ",", name.c_str(), curve.c_str(), bits, iterations * batch, ns[REPETITIONS / 2], cycles[REPETITIONS / 2], allocs[REPETITIONS / 2]);
+        std::cout << line << std::flush;
+        first = false;
+    }
+};
+
+// a normal basis for the field of a named binary curve: the first small element whose conjugates are independent
+static BasisConversion findConversion(const GF2Polynomial& prime)
+{
+    for (uint8_t candidate = 2; candidate != 0; ++candidate) {
+        try {
+            return BasisConversion(prime, BigNum(std::vector<uint8_t>{candidate}));
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    throw std::runtime_error("bench: no normal basis root found");
+}
+
+static void benchBigNum(Bench& bench, const std::string& name, const EllipticCurve& curve)
+{
+    auto bits = curve.order.BitLength();
+    auto a = randomBelow(curve.order);
+    auto b = randomBelow(curve.order);
+    auto product = a * b;
+
+    bench.Run("bignum.add", name, bits, [&]() { auto r = a + b; });
+    bench.Run("bignum.mul", name, bits, [&]() { auto r = a * b; });
+    bench.Run("bignum.mod", name, bits, [&]() { auto r = product % curve.order; });
+}
+
+static void benchBinaryField(Bench& bench, const std::string& name, const EllipticCurve& curve)
+{
+    auto group = curve.group->RawPtr();
+    auto p = BigNum(BN_new());
+    EC_GROUP_get_curve(group, p.RawPtr(), nullptr, nullptr, BNContext::Get());
+
+    auto prime = GF2Polynomial(p);
+    auto degree = curve.group->FieldSize();
+    auto x = GF2Polynomial(degree, BigNum(randomBytes((degree + 7) / 8)));
+    auto y = GF2Polynomial(degree, BigNum(randomBytes((degree + 7) / 8)));
+    auto product = x * y;
+    ScratchArena arena;
+
+    bench.Run("gf2poly.mul", name, degree, [&]() { auto r = x * y; });
+    bench.Run("gf2poly.mul_scratch", name, degree, [&]() { ScratchScope scope(arena); auto r = x * y; });
+    bench.Run("gf2poly.mod", name, degree, [&]() { auto r = product % prime; });
+    bench.Run("gf2poly.reverse", name, degree, [&]() { auto r = x.ReverseBits(); });
+
+    auto conversion = findConversion(prime);
+    auto& matrix = conversion.Matrix();
+    bench.Run("gf2matrix.invert", name, degree, [&]() { auto r = matrix.Invert(); });
+    bench.Run("gf2matrix.multiply", name, degree, [&]() { auto r = matrix.Multiply(x); });
+
+    const size_t count = 256;
+    auto words = matrix.Stride();
+    auto vectors = std::vector<uint64_t>(count * words);
+    auto results = std::vector<uint64_t>(count * words);
+    for (size_t i = 0; i < count; ++i) {
+        auto w = GF2Polynomial(degree, BigNum(randomBytes((degree + 7) / 8))).Words();
+        std::copy(w.begin(), w.end(), vectors.begin() + i * words);
+    }
+    bench.Run("gf2matrix.multiply_batch", name, degree, [&]() { matrix.Multiply(vectors.data(), results.data(), count); }, count);
+
+    auto element = BigNum(randomBytes((degree + 7) / 8)) % p;
+    bench.Run("basis.convert_nb", name, degree, [&]() { auto r = conversion.ConvertNB(element); });
+    bench.Run("basis.convert_nb_scratch", name, degree, [&]() { ScratchScope scope(arena); auto r = conversion.ConvertNB(element); });
+    bench.Run("basis.convert_pb", name, degree, [&]() { auto r = conversion.ConvertPB(element); });
+
+    auto length = conversion.ElementBytes();
+    auto src = std::vector<uint8_t>(count * length);
+    auto dst = std::vector<uint8_t>(count * length);
+    for (size_t i = 0; i < count; ++i) {
+        auto bytes = (BigNum(randomBytes(length)) % p).ToByteVector();
+        std::copy(bytes.begin(), bytes.end(), src.begin() + (i + 1) * length - bytes.size());
+    }
+    bench.Run("basis.convert_nb_batch", name, degree, [&]() { conversion.ConvertNB(src.data(), dst.data(), count); }, count);
+}
+
+static void benchPoints(Bench& bench, const std::string& name, const EllipticCurve& curve)
+{
+    auto bits = curve.group->FieldSize();
+    auto k = randomBelow(curve.order);
+    auto p1 = curve.Multiply(randomBelow(curve.order));
+    auto p2 = curve.Multiply(randomBelow(curve.order));
+
+    bench.Run("ec.add", name, bits, [&]() { auto r = p1 + p2; });
+    bench.Run("ec.mul", name, bits, [&]() { auto r = k * p1; });
+    bench.Run("ec.mul_generator", name, bits, [&]() { auto r = curve.Multiply(k); });
+    bench.Run("ec.mul_generator_public", name, bits, [&]() { auto r = curve.MultiplyPublic(k); });
+    bench.Run("ec.compress", name, bits, [&]() { auto r = curve.Point2VecCompressed(p1); });
+
+    auto compressed = curve.Point2VecCompressed(p1);
+    auto x = std::vector<uint8_t>(compressed.begin() + 1, compressed.end());
+    bench.Run("ec.decompress", name, bits, [&]() { auto r = curve.Point(x, compressed[0] & 0x1); });
+    bench.Run("ec.validate", name, bits, [&]() { sink = curve.IsValidPoint(p1); });
+
+    const size_t count = 256;
+    auto points = std::vector<ECPoint>();
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back(curve.Multiply(randomBelow(curve.order)));
+    }
+
+    auto length = curve.EncodedLength(true);
+    auto encoded = std::vector<uint8_t>(count * length);
+    curve.Encode(points, encoded.data(), encoded.size(), true);
+
+    auto decoded = std::vector<ECPoint>();
+    bench.Run("ec.encode_batch", name, bits, [&]() { curve.Encode(points, encoded.data(), encoded.size(), true); }, count);
+    bench.Run("ec.decode_batch", name, bits, [&]() { curve.Decode(encoded.data(), encoded.size(), decoded); }, count);
+    bench.Run("ec.validate_batch", name, bits, [&]() { auto r = curve.ValidateEncodings(encoded.data(), encoded.size()); }, count);
+}
+
+int main(int argc, const char** argv)
+{
+    // must come before OpenSSL allocates anything
+    auto opensslCounted = (1 == CRYPTO_set_mem_functions(countedMalloc, countedRealloc, countedFree));
+
+    auto bench = Bench(argc > 1 ? argv[1] : "");
+    const char* curves[] = { "P-224", "P-256", "P-384", "P-521", "K-163", "K-283", "K-409", "K-571" };
+
+    std::cout << "{" << std::endl;
+    std::cout << "  \"commit\": \"" << ECC_BENCH_COMMIT << "\"," << std::endl;
+    std::cout << "  \"compiler\": \"" << __VERSION__ << "\"," << std::endl;
+    std::cout << "  \"openssl\": \"" << OPENSSL_VERSION_TEXT << "\"," << std::endl;
+    std::cout << "  \"openssl_allocs_counted\": " << (opensslCounted ? "true" : "false") << "," << std::endl;
+    std::cout << "  \"results\": [";
+
+    for (auto name : curves) {
+        auto curve = CurveRegistry::Get(name);
+
+        benchBigNum(bench, name, *curve);
+        if (name[0] == 'K') {
+            benchBinaryField(bench, name, *curve);
+        }
+        benchPoints(bench, name, *curve);
+    }
+
+    std::cout << std::endl << "  ]" << std::endl << "}" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
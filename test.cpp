@@ -1,196 +1,862 @@
-/**
- * MIT License
- *
- * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "ECBuilder.h"
-#include "BasisConversion.h"
-
-#include <iostream>
-#include <iomanip>
-#include <cstring>
-#include <vector>
-
-using namespace ecc;
-
-static void print(const std::string& title, bool result) {
-    std::cout << title << ": ";
-    std::cout << std::boolalpha << result << std::noboolalpha << std::endl;
-}
-
-static void print(const std::vector<uint8_t>& vec)
-{
-    std::cout << "(" << vec.size() << ") ";
-    std::cout << std::hex;
-    for (auto letter : vec) {
-        std::cout << std::setfill('0') << std::setw(2) << +letter;
-    }
-    std::cout << std::dec << std::endl;
-}
-
-static void print(const std::string& name, const ECPoint& p) {
-    std::cout << name << ": " <<  p.ToString() << std::endl;
-}
-
-static EllipticCurve SecgK409Curve()
-{
-    /* Binary data for the curve parameters for SECG K-409 curve*/
-    std::vector<uint8_t> a = {
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00,
-    };
-
-    std::vector<uint8_t> b = {
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x01,
-    };
-
-    // if a prime field is used, p is the prime number
-    // if a binary field is used, p is the irreducible polynomial
-    std::vector<uint8_t> p = {
-        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x01,
-    };
-
-    std::vector<uint8_t> order = {
-        0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-        0xFF, 0xFF, 0xFE, 0x5F, 0x83, 0xB2, 0xD4, 0xEA, 0x20, 0x40, 0x0E, 0xC4,
-        0x55, 0x7D, 0x5E, 0xD3, 0xE3, 0xE7, 0xCA, 0x5B, 0x4B, 0x5C, 0x83, 0xB8,
-        0xE0, 0x1E, 0x5F, 0xCF
-    };
-
-    std::vector<uint8_t> x = {
-        0x00, 0x60, 0xF0, 0x5F, 0x65, 0x8F, 0x49, 0xC1, 0xAD, 0x3A, 0xB1, 0x89,
-        0x0F, 0x71, 0x84, 0x21, 0x0E, 0xFD, 0x09, 0x87, 0xE3, 0x07, 0xC8, 0x4C,
-        0x27, 0xAC, 0xCF, 0xB8, 0xF9, 0xF6, 0x7C, 0xC2, 0xC4, 0x60, 0x18, 0x9E,
-        0xB5, 0xAA, 0xAA, 0x62, 0xEE, 0x22, 0x2E, 0xB1, 0xB3, 0x55, 0x40, 0xCF,
-        0xE9, 0x02, 0x37, 0x46,
-    };
-
-    std::vector<uint8_t> y ={
-        0x01, 0xE3, 0x69, 0x05, 0x0B, 0x7C, 0x4E, 0x42, 0xAC, 0xBA, 0x1D, 0xAC,
-        0xBF, 0x04, 0x29, 0x9C, 0x34, 0x60, 0x78, 0x2F, 0x91, 0x8E, 0xA4, 0x27,
-        0xE6, 0x32, 0x51, 0x65, 0xE9, 0xEA, 0x10, 0xE3, 0xDA, 0x5F, 0x6C, 0x42,
-        0xE9, 0xC5, 0x52, 0x15, 0xAA, 0x9C, 0xA2, 0x7A, 0x58, 0x63, 0xEC, 0x48,
-        0xD8, 0xE0, 0x28, 0x6B,
-    };
-
-    // not a real root. should be corrected
-    std::vector<uint8_t> root ={
-        0x01, 0xE3, 0x69, 0x05, 0x0B, 0x7C, 0x4E, 0x42, 0xAC, 0xBA, 0x1D, 0xAC,
-        0xBF, 0x04, 0x29, 0x9C, 0x34, 0x60, 0x78, 0x2F, 0x91, 0x8E, 0xA4, 0x27,
-        0xE6, 0x32, 0x51, 0x65, 0xE9, 0xEA, 0x10, 0xE3, 0xDA, 0x5F, 0x6C, 0x42,
-        0xE9, 0xC5, 0x52, 0x15, 0xAA, 0x9C, 0xA2, 0x7A, 0x58, 0x63, 0xEC, 0x48,
-        0xD8, 0xE0, 0x28, 0x6B,
-    };
-
-    auto builder = ECBuilder();
-
-    builder.FieldSize(409).Irreducible(p).Order(order).A(a).B(b).X(x).Y(y).Root(root);
-
-    return builder.BuildGF2m();
-}
-
-static void testAddition(EllipticCurve& curve)
-{
-    auto p1 = curve.RandomPoint();
-    auto p2 = curve.RandomPoint();
-    auto p3 = p1 + p2;
-
-    print("Point Addition", curve.IsValidPoint(p3));
-    print("p1", p1);
-    print("p2", p2);
-    print("p3", p3);
-    std::cout << std::endl;
-}
-
-static void testMultiplication(EllipticCurve& curve)
-{
-    auto k = curve.RandomScalar();
-    auto p1 = curve.RandomPoint();
-    auto p2 = k * p1;
-
-    print("Point Multiplication", curve.IsValidPoint(p2));
-    print("p1", p1);
-    print("p2", p2);
-    std::cout << std::endl;
-}
-
-static void testCompression(EllipticCurve& curve)
-{
-    auto p1 = curve.RandomPoint();
-    auto buf = curve.Point2VecCompressed(p1);
-    std::vector<uint8_t> x;
-    x.assign(buf.begin() + 1, buf.end());
-
-    // buf[0] == 0x02 = 0; // compressed (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
-    // buf[0] == 0x03 = 1; // compressed (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
-    // buf[0] == 0x04 = uncomressed  (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
-    auto p2 = curve.Point(x, buf[0]);
-
-    print("Point Compression", curve.IsValidPoint(p2));
-    print(buf);
-    print("p1", p1);
-    print("compressed", p2);
-    print(curve.Point2Vec(p2));
-    std::cout << std::endl;
-}
-
-static void testBasisConversion(EllipticCurve& curve)
-{
-    std::vector<uint8_t> data = {
-        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
-        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
-        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
-        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
-        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
-        0x50, 0x51,
-    };
-
-    auto pb = curve.ConvertPB(data);
-    auto nb = curve.ConvertNB(pb);
-
-    std::cout << "polynomial basis: " << pb.ToString() << std::endl;
-    std::cout << "    normal basis: " << nb.ToString() << std::endl;
-}
-
-int main(int argc, const char** argv)
-{
-    auto curve = SecgK409Curve();
-
-    testAddition(curve);
-    testMultiplication(curve);
-    testCompression(curve);
-    testBasisConversion(curve);
-
-    return 0;
+/**
+ * MIT License
+ *
+ * Copyright (c) 2021 Ilwoong Jeong (https://github.com/ilwoong)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ECBuilder.h"
+#include "BasisConversion.h"
+#include "CurveRegistry.h"
+#include "AsyncCurve.h"
+#include "ScratchArena.h"
+#include "MultiScalar.h"
+#include "GF2Modulus.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ecc;
+
+static void print(const std::string& title, bool result) {
+    std::cout << title << ": ";
+    std::cout << std::boolalpha << result << std::noboolalpha << std::endl;
+}
+
+static void print(const std::vector<uint8_t>& vec)
+{
+    std::cout << "(" << vec.size() << ") ";
+    std::cout << std::hex;
+    for (auto letter : vec) {
+        std::cout << std::setfill('0') << std::setw(2) << +letter;
+    }
+    std::cout << std::dec << std::endl;
+}
+
+static void print(const std::string& name, const ECPoint& p) {
+    std::cout << name << ": " <<  p.ToString() << std::endl;
+}
+
+static ECBuilder SecgK409Builder()
+{
+    /* Binary data for the curve parameters for SECG K-409 curve*/
+    std::vector<uint8_t> a = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00,
+    };
+
+    std::vector<uint8_t> b = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x01,
+    };
+
+    // if a prime field is used, p is the prime number
+    // if a binary field is used, p is the irreducible polynomial
+    std::vector<uint8_t> p = {
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x01,
+    };
+
+    std::vector<uint8_t> order = {
+        0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFE, 0x5F, 0x83, 0xB2, 0xD4, 0xEA, 0x20, 0x40, 0x0E, 0xC4,
+        0x55, 0x7D, 0x5E, 0xD3, 0xE3, 0xE7, 0xCA, 0x5B, 0x4B, 0x5C, 0x83, 0xB8,
+        0xE0, 0x1E, 0x5F, 0xCF
+    };
+
+    std::vector<uint8_t> x = {
+        0x00, 0x60, 0xF0, 0x5F, 0x65, 0x8F, 0x49, 0xC1, 0xAD, 0x3A, 0xB1, 0x89,
+        0x0F, 0x71, 0x84, 0x21, 0x0E, 0xFD, 0x09, 0x87, 0xE3, 0x07, 0xC8, 0x4C,
+        0x27, 0xAC, 0xCF, 0xB8, 0xF9, 0xF6, 0x7C, 0xC2, 0xC4, 0x60, 0x18, 0x9E,
+        0xB5, 0xAA, 0xAA, 0x62, 0xEE, 0x22, 0x2E, 0xB1, 0xB3, 0x55, 0x40, 0xCF,
+        0xE9, 0x02, 0x37, 0x46,
+    };
+
+    std::vector<uint8_t> y ={
+        0x01, 0xE3, 0x69, 0x05, 0x0B, 0x7C, 0x4E, 0x42, 0xAC, 0xBA, 0x1D, 0xAC,
+        0xBF, 0x04, 0x29, 0x9C, 0x34, 0x60, 0x78, 0x2F, 0x91, 0x8E, 0xA4, 0x27,
+        0xE6, 0x32, 0x51, 0x65, 0xE9, 0xEA, 0x10, 0xE3, 0xDA, 0x5F, 0x6C, 0x42,
+        0xE9, 0xC5, 0x52, 0x15, 0xAA, 0x9C, 0xA2, 0x7A, 0x58, 0x63, 0xEC, 0x48,
+        0xD8, 0xE0, 0x28, 0x6B,
+    };
+
+    // not a real root. should be corrected
+    std::vector<uint8_t> root ={
+        0x01, 0xE3, 0x69, 0x05, 0x0B, 0x7C, 0x4E, 0x42, 0xAC, 0xBA, 0x1D, 0xAC,
+        0xBF, 0x04, 0x29, 0x9C, 0x34, 0x60, 0x78, 0x2F, 0x91, 0x8E, 0xA4, 0x27,
+        0xE6, 0x32, 0x51, 0x65, 0xE9, 0xEA, 0x10, 0xE3, 0xDA, 0x5F, 0x6C, 0x42,
+        0xE9, 0xC5, 0x52, 0x15, 0xAA, 0x9C, 0xA2, 0x7A, 0x58, 0x63, 0xEC, 0x48,
+        0xD8, 0xE0, 0x28, 0x6B,
+    };
+
+    auto builder = ECBuilder();
+
+    builder.FieldSize(409).Irreducible(p).Order(order).A(a).B(b).X(x).Y(y).Root(root);
+
+    return builder;
+}
+
+static EllipticCurve SecgK409Curve()
+{
+    return SecgK409Builder().BuildGF2m();
+}
+
+static void testAddition(EllipticCurve& curve)
+{
+    auto p1 = curve.RandomPoint();
+    auto p2 = curve.RandomPoint();
+    auto p3 = p1 + p2;
+
+    print("Point Addition", curve.IsValidPoint(p3));
+    print("p1", p1);
+    print("p2", p2);
+    print("p3", p3);
+    std::cout << std::endl;
+}
+
+static void testMultiplication(EllipticCurve& curve)
+{
+    auto k = curve.RandomScalar();
+    auto p1 = curve.RandomPoint();
+    auto p2 = k * p1;
+
+    // the compound operators work in place on the same point
+    auto p3 = p1;
+    p3 *= k;
+    p3 += p1;
+    auto compound = curve.Point2Vec(p3) == curve.Point2Vec(p2 + p1);
+
+    print("Point Multiplication", curve.IsValidPoint(p2) && compound);
+    print("p1", p1);
+    print("p2", p2);
+    std::cout << std::endl;
+}
+
+static void testGeneratorMultiplication(EllipticCurve& curve)
+{
+    auto k = curve.RandomScalar();
+    auto generator = curve.Multiply(BigNum(std::vector<uint8_t>{0x01}));
+    auto p1 = curve.Multiply(k);
+    auto p2 = k * generator;
+    auto p3 = curve.MultiplyPublic(k);
+
+    print("Generator Multiplication", (curve.Point2Vec(p1) == curve.Point2Vec(p2)) && (curve.Point2Vec(p1) == curve.Point2Vec(p3)));
+    print("p1", p1);
+    print("p2", p2);
+    std::cout << std::endl;
+}
+
+static void testBatchNormalization(EllipticCurve& curve)
+{
+    auto p1 = curve.RandomPoint();
+    auto points = std::vector<ECPoint>();
+    for (auto i = 0; i < 8; ++i) {
+        p1 = p1 + curve.RandomPoint();
+        points.push_back(p1);
+    }
+
+    auto expected = std::vector<std::vector<uint8_t>>();
+    for (auto& point : points) {
+        expected.push_back(curve.Point2Vec(point));
+    }
+
+    curve.MakeAffine(points);
+
+    auto result = true;
+    for (auto i = 0; i < points.size(); ++i) {
+        result &= (curve.Point2Vec(points[i]) == expected[i]);
+    }
+
+    print("Batch Normalization", result);
+    std::cout << std::endl;
+}
+
+// k * P from doublings and additions only. EC_POINT_mul cannot be the reference on binary curves:
+// OpenSSL's EC_POINT_invert takes every point with y = 0 for its own negative, but -(x, y) is (x, x + y),
+// and the ladder negates through it, so that 3 * (1, 0) on K-409 comes out as (1, 0) instead of (1, 1)
+static ECPoint referenceMultiply(const EllipticCurve& curve, const BigNum& k, const ECPoint& point)
+{
+    auto result = ECPoint(curve.group);
+    for (auto byte : k.ToByteVector()) {
+        for (auto bit = 8; bit-- > 0;) {
+            result = result + result;
+            if ((byte >> bit) & 0x01) {
+                result = result + point;
+            }
+        }
+    }
+
+    return result;
+}
+
+// a curve point whose order is a multiple of the prime order n, but not n, so it lies outside the generated subgroup.
+// x = 0 and x = 1 are (0, sqrt(b)) and (1, 0), the points of order 2 and 4 on K-409, and are skipped
+static ECPoint cofactorPoint(const EllipticCurve& curve)
+{
+    for (uint8_t x = 2; x != 0; ++x) {
+        // the point at infinity encodes as a single zero byte
+        auto point = curve.Point(std::vector<uint8_t>{x}, 0);
+        auto finite = curve.Point2Vec(point)[0] == 0x04;
+        if (finite && curve.IsValidPoint(point) && (curve.Point2Vec(curve.order * point)[0] == 0x04)) {
+            return point;
+        }
+    }
+
+    throw std::runtime_error("no point outside the subgroup");
+}
+
+// scalars are at least the order n. when the curve has a cofactor the first point lies outside the subgroup,
+// and the next two are the points of order 2 and 4
+static bool checkMultiScalar(const EllipticCurve& curve, size_t count, size_t threads, bool cofactor)
+{
+    auto scalars = std::vector<BigNum>();
+    auto points = std::vector<ECPoint>();
+    for (size_t i = 0; i < count; ++i) {
+        scalars.push_back(curve.order + curve.RandomScalar());
+        points.push_back(curve.RandomPoint());
+    }
+
+    if (cofactor) {
+        points[0] = cofactorPoint(curve);
+        points[1] = curve.Point(std::vector<uint8_t>{0x00}, 0);
+        points[2] = curve.Point(std::vector<uint8_t>{0x01}, 0);
+    }
+
+    auto expected = ECPoint(curve.group);
+    for (size_t i = 0; i < points.size(); ++i) {
+        expected = expected + referenceMultiply(curve, scalars[i], points[i]);
+    }
+
+    return curve.Point2Vec(curve.MultiScalarMultiply(scalars, points, threads)) == curve.Point2Vec(expected);
+}
+
+static void testMultiScalarMultiplication(EllipticCurve& curve)
+{
+    auto scalars = std::vector<BigNum>();
+    auto points = std::vector<ECPoint>();
+    for (auto i = 0; i < 8; ++i) {
+        scalars.push_back(curve.RandomScalar());
+        points.push_back(curve.RandomPoint());
+    }
+
+    auto expected = scalars[0] * points[0];
+    for (auto i = 1; i < points.size(); ++i) {
+        expected = expected + scalars[i] * points[i];
+    }
+
+    auto result = curve.MultiScalarMultiply(scalars, points);
+
+    auto large = 2 * MultiScalar::STRAUS_THRESHOLD;
+    auto prime = CurveRegistry::Get("P-256");
+
+    auto success = curve.Point2Vec(result) == curve.Point2Vec(expected);
+    success &= checkMultiScalar(curve, 8, 1, true);
+    success &= checkMultiScalar(curve, large, 1, true);
+    success &= checkMultiScalar(curve, large, 2, true);
+    success &= checkMultiScalar(*prime, 8, 1, false);
+    success &= checkMultiScalar(*prime, large, 2, false);
+
+    print("Multi-Scalar Multiplication", success);
+    print("sum", result);
+    std::cout << std::endl;
+}
+
+static void testBatchMultiplication(EllipticCurve& curve)
+{
+    auto scalars = std::vector<BigNum>();
+    auto points = std::vector<ECPoint>();
+    for (auto i = 0; i < 8; ++i) {
+        scalars.push_back(curve.RandomScalar());
+        points.push_back(curve.RandomPoint());
+    }
+
+    auto products = curve.BatchMultiply(scalars, points, 4);
+    auto generators = curve.BatchMultiply(scalars, 4);
+
+    auto result = (products.size() == points.size()) && (generators.size() == points.size());
+    for (auto i = 0; result && (i < points.size()); ++i) {
+        result &= (curve.Point2Vec(products[i]) == curve.Point2Vec(points[i] * scalars[i]));
+        result &= (curve.Point2Vec(generators[i]) == curve.Point2Vec(curve.Multiply(scalars[i])));
+    }
+
+    print("Batch Multiplication", result);
+    std::cout << std::endl;
+}
+
+static void testAsyncMultiplication(EllipticCurve& curve)
+{
+    AsyncCurve async(std::make_shared<EllipticCurve>(curve));
+
+    auto scalars = std::vector<BigNum>();
+    auto points = std::vector<ECPoint>();
+    auto futures = std::vector<std::future<ECPoint>>();
+    for (auto i = 0; i < 8; ++i) {
+        scalars.push_back(curve.RandomScalar());
+        points.push_back(curve.RandomPoint());
+        futures.push_back(async.Multiply(scalars[i], points[i]));
+    }
+
+    auto result = true;
+    for (auto i = 0; i < futures.size(); ++i) {
+        result &= (curve.Point2Vec(futures[i].get()) == curve.Point2Vec(points[i] * scalars[i]));
+    }
+
+    print("Async Multiplication", result);
+    std::cout << std::endl;
+}
+
+static void testCompression(EllipticCurve& curve)
+{
+    auto p1 = curve.RandomPoint();
+    auto buf = curve.Point2VecCompressed(p1);
+    std::vector<uint8_t> x;
+    x.assign(buf.begin() + 1, buf.end());
+
+    // buf[0] == 0x02 = 0; // compressed (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
+    // buf[0] == 0x03 = 1; // compressed (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
+    // buf[0] == 0x04 = uncomressed  (defined in SEC 1: Elliptic Curve Cryptography, Version 2.0)
+    auto p2 = curve.Point(x, buf[0]);
+
+    print("Point Compression", curve.IsValidPoint(p2));
+    print(buf);
+    print("p1", p1);
+    print("compressed", p2);
+    print(curve.Point2Vec(p2));
+    std::cout << std::endl;
+}
+
+static void testBatchEncoding(EllipticCurve& curve)
+{
+    auto points = std::vector<ECPoint>();
+    auto expected = std::vector<std::vector<uint8_t>>();
+    for (auto i = 0; i < 8; ++i) {
+        points.push_back(curve.RandomPoint() + curve.RandomPoint());
+        expected.push_back(curve.Point2VecCompressed(points.back()));
+    }
+
+    auto length = curve.EncodedLength(true);
+    auto buf = std::vector<uint8_t>(points.size() * length);
+    curve.Encode(points, buf.data(), buf.size(), true);
+
+    auto decoded = std::vector<ECPoint>();
+    curve.Decode(buf.data(), buf.size(), decoded);
+
+    auto result = (decoded.size() == points.size());
+    for (auto i = 0; result && (i < points.size()); ++i) {
+        result &= std::equal(expected[i].begin(), expected[i].end(), buf.begin() + i * length);
+        result &= (curve.Point2Vec(decoded[i]) == curve.Point2Vec(points[i]));
+    }
+
+    print("Batch Encoding", result);
+    std::cout << std::endl;
+}
+
+// entry i % 16 of the batch is made hybrid with the right y bit when 1, broken when 2 to 5 and kept otherwise:
+// a wrong hybrid y bit (2), an x or y off the curve (3), an x beyond the field (4) or an unknown prefix (5)
+static bool checkValidation(const EllipticCurve& curve, bool compressed)
+{
+    const size_t count = 256;
+    auto length = curve.EncodedLength(compressed);
+    auto fieldBytes = curve.EncodedLength(true) - 1;
+
+    auto points = std::vector<ECPoint>();
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back(curve.RandomPoint());
+    }
+
+    auto buf = std::vector<uint8_t>(count * length);
+    curve.Encode(points, buf.data(), buf.size(), compressed);
+
+    // a single encoding is valid iff Decode accepts it
+    auto decodes = [&](const uint8_t* src) {
+        auto decoded = std::vector<ECPoint>();
+        try {
+            curve.Decode(src, length, decoded);
+            return true;
+        } catch (const std::invalid_argument&) {
+            return false;
+        }
+    };
+
+    auto result = true;
+    auto expected = std::vector<uint64_t>(count / 64);
+    for (size_t i = 0; i < count; ++i) {
+        auto src = &buf[i * length];
+        auto kind = i % 16;
+
+        if ((kind == 1) || (kind == 2)) {
+            src[0] = compressed ? src[0] : (0x04 | curve.Point2VecCompressed(points[i])[0]);
+            src[0] ^= (kind == 2) ? 0x01 : 0x00;
+        } else if (kind == 3) {
+            // the other y of x is y + x or p - y, never y with its low bit flipped
+            src[length - 1] ^= 0x01;
+            for (auto tweak = 0; compressed && decodes(src) && (tweak < 256); ++tweak) {
+                src[length - 1] += 1;
+            }
+        } else if (kind == 4) {
+            std::fill(src + 1, src + 1 + fieldBytes, 0xff);
+        } else if (kind == 5) {
+            src[0] = 0x05;
+        }
+
+        // a compressed entry of kind 1 or 2 names the point or its negative
+        auto valid = (kind == 0) || (kind == 1) || (kind > 5) || ((kind == 2) && compressed);
+        result &= (valid == decodes(src));
+        if (valid) {
+            expected[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3f);
+        }
+    }
+
+    return result && (curve.ValidateEncodings(buf.data(), buf.size(), 4) == expected);
+}
+
+static void testBatchValidation(EllipticCurve& curve)
+{
+    auto points = std::vector<ECPoint>();
+    for (auto i = 0; i < 8; ++i) {
+        points.push_back(curve.RandomPoint());
+    }
+
+    auto length = curve.EncodedLength(true);
+    auto buf = std::vector<uint8_t>(points.size() * length);
+    curve.Encode(points, buf.data(), buf.size(), true);
+    buf[3 * length] = 0x05;
+
+    auto validPoints = curve.ValidatePoints(points, 2);
+    auto validEncodings = curve.ValidateEncodings(buf.data(), buf.size(), 2);
+
+    auto prime = CurveRegistry::Get("P-256");
+    auto result = (validPoints[0] == 0xff) && (validEncodings[0] == 0xf7);
+    result &= checkValidation(curve, false) && checkValidation(curve, true);
+    result &= checkValidation(*prime, false) && checkValidation(*prime, true);
+
+    print("Batch Validation", result);
+    std::cout << std::endl;
+}
+
+static void testCurveRegistry(EllipticCurve& curve)
+{
+    auto byName = CurveRegistry::Get("sect409k1");
+    auto byNist = CurveRegistry::Get("K-409");
+    auto byOid = CurveRegistry::Get("1.3.132.0.36");
+
+    auto one = BigNum(std::vector<uint8_t>{0x01});
+    auto sameCurve = (byName == byNist) && (byName == byOid);
+    auto sameGenerator = curve.Point2Vec(curve.Multiply(one)) == byName->Point2Vec(byName->Multiply(one));
+
+    // the prime curves keep OpenSSL's own group, whose generator path is checked against k * G
+    auto prime = CurveRegistry::Get("P-256");
+    auto k = prime->RandomScalar();
+    auto expected = prime->Point2Vec(k * prime->Multiply(one));
+    sameGenerator &= (prime->Point2Vec(prime->Multiply(k)) == expected) && (prime->Point2Vec(prime->MultiplyPublic(k)) == expected);
+
+    // only registry groups are interned, a built group goes away with its last curve and point
+    auto built = std::weak_ptr<ECGroup>();
+    {
+        auto other = SecgK409Curve();
+        auto point = other.RandomPoint() + other.RandomPoint();
+        built = other.group;
+    }
+    auto interned = byName->group->IsInterned() && !curve.group->IsInterned() && built.expired();
+
+    print("Curve Registry", sameCurve && sameGenerator && interned);
+    std::cout << std::endl;
+}
+
+static void testScratchArena(EllipticCurve& curve)
+{
+    auto point = curve.RandomPoint();
+    auto expected = curve.ConvertNB(point);
+
+    ScratchArena arena;
+    auto result = true;
+    for (auto i = 0; i < 4; ++i) {
+        ScratchScope scope(arena);
+        auto converted = curve.ConvertNB(point);
+        result &= (converted.first == expected.first) && (converted.second == expected.second);
+    }
+
+    print("Scratch Arena", result && (ScratchArena::Current() == nullptr));
+    std::cout << std::endl;
+}
+
+// the first build stores the conversion, the second maps it, and a corrupted or group writable file is rebuilt and replaced
+static void testConversionCache(EllipticCurve& curve)
+{
+    char directory[] = "/tmp/ecc-cache-XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        print("Conversion Cache", false);
+        return;
+    }
+
+    auto builder = SecgK409Builder();
+    builder.CacheDirectory(directory);
+
+    auto point = curve.RandomPoint();
+    auto expected = curve.ConvertNB(point);
+    auto matches = [&](const EllipticCurve& cached) {
+        auto converted = cached.ConvertNB(point);
+        return (converted.first == expected.first) && (converted.second == expected.second);
+    };
+
+    auto result = matches(builder.BuildGF2m());
+
+    auto path = std::string();
+    auto dir = opendir(directory);
+    for (auto entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            path = std::string(directory) + "/" + entry->d_name;
+        }
+    }
+    closedir(dir);
+
+    struct stat stored;
+    result &= !path.empty() && (stat(path.c_str(), &stored) == 0);
+
+    struct stat loaded;
+    result &= matches(builder.BuildGF2m());
+    result &= (stat(path.c_str(), &loaded) == 0) && (loaded.st_ino == stored.st_ino);
+
+    auto file = std::fopen(path.c_str(), "r+b");
+    if (file != nullptr) {
+        std::fseek(file, -1, SEEK_END);
+        auto last = std::fgetc(file);
+        std::fseek(file, -1, SEEK_END);
+        std::fputc(last ^ 0x01, file);
+        std::fclose(file);
+    }
+
+    struct stat rebuilt;
+    result &= (file != nullptr) && matches(builder.BuildGF2m());
+    result &= (stat(path.c_str(), &rebuilt) == 0) && (rebuilt.st_ino != stored.st_ino);
+
+    // a file that other users could have written is not trusted either
+    struct stat replaced;
+    result &= (chmod(path.c_str(), 0660) == 0) && matches(builder.BuildGF2m());
+    result &= (stat(path.c_str(), &replaced) == 0) && (replaced.st_ino != rebuilt.st_ino) && ((replaced.st_mode & 0777) == 0600);
+
+    unlink(path.c_str());
+    rmdir(directory);
+
+    print("Conversion Cache", result);
+    std::cout << std::endl;
+}
+
+// random operands at every binary field size, checked against OpenSSL's BN_GF2m routines on both multiplication kernels
+// and on the sparse and generic reduction paths
+static void testPolynomialArithmetic(EllipticCurve& curve)
+{
+    // x^m + terms + 1, the SEC 2 reduction polynomials for sect163 to sect571
+    std::vector<std::vector<int>> moduli = {
+        {163, 7, 6, 3, 0, -1},
+        {233, 74, 0, -1},
+        {283, 12, 7, 5, 0, -1},
+        {409, 87, 0, -1},
+        {571, 10, 5, 2, 0, -1},
+    };
+
+    auto ctx = BN_CTX_new();
+    auto random = [](int bits) {
+        BigNum num(BN_new());
+        BN_rand(num.RawPtr(), bits, BN_RAND_TOP_ONE, BN_RAND_BOTTOM_ANY);
+        return num;
+    };
+
+    auto result = true;
+    for (auto& terms : moduli) {
+        auto m = terms[0];
+
+        // x^(2m + 1) + 1 is never reached by a product of two m-bit operands, so it leaves the product unreduced
+        int unreduced[] = {2 * m + 1, 0, -1};
+
+        // a dense modulus of the same degree takes the generic reduction
+        auto dense = random(m + 1);
+        BN_set_bit(dense.RawPtr(), 0);
+        std::vector<int> denseTerms(m + 2);
+        denseTerms.resize(BN_GF2m_poly2arr(dense.RawPtr(), denseTerms.data(), static_cast<int>(denseTerms.size())));
+        denseTerms.push_back(-1);
+
+        BigNum sparse(BN_new());
+        BN_GF2m_arr2poly(terms.data(), sparse.RawPtr());
+
+        for (auto modulus : {std::make_pair(&sparse, terms.data()), std::make_pair(&dense, denseTerms.data())}) {
+            auto f = GF2Polynomial(*modulus.first);
+            auto reducer = GF2Modulus(f);
+
+            for (auto i = 0; i < 16; ++i) {
+                auto a = random(m);
+                auto b = random((i & 1) ? m : (m >> 2));
+                auto wide = random(2 * m - 1);
+                auto lhs = GF2Polynomial(a);
+                auto rhs = GF2Polynomial(b);
+
+                BigNum product(BN_new()), remainder(BN_new()), reduced(BN_new()), square(BN_new());
+                BN_GF2m_mod_mul_arr(product.RawPtr(), a.RawPtr(), b.RawPtr(), unreduced, ctx);
+                BN_GF2m_mod_arr(remainder.RawPtr(), product.RawPtr(), modulus.second);
+                BN_GF2m_mod_arr(reduced.RawPtr(), wide.RawPtr(), modulus.second);
+                BN_GF2m_mod_sqr_arr(square.RawPtr(), a.RawPtr(), modulus.second, ctx);
+
+                result &= (lhs * rhs).ToBigNum() == product;
+                result &= GF2Polynomial::Multiply(lhs, rhs, GF2Polynomial::Kernel::Comb).ToBigNum() == product;
+                result &= ((lhs * rhs) % f).ToBigNum() == remainder;
+                result &= reducer.Multiply(lhs, rhs).ToBigNum() == remainder;
+                result &= reducer.Reduce(GF2Polynomial(wide)).ToBigNum() == reduced;
+                result &= reducer.Square(lhs).ToBigNum() == square;
+            }
+
+            result &= reducer.Type() == ((modulus.first == &dense) ? GF2Modulus::Kind::Generic : ((terms.size() == 4) ? GF2Modulus::Kind::Trinomial : GF2Modulus::Kind::Pentanomial));
+        }
+    }
+    BN_CTX_free(ctx);
+
+    print("Polynomial Arithmetic", result);
+    std::cout << std::endl;
+}
+
+// rank by plain Gaussian elimination, the reference for the blocked inverse
+static size_t referenceRank(const GF2Matrix& matrix)
+{
+    auto words = (matrix.Cols() + 63) >> 6;
+    std::vector<std::vector<uint64_t>> rows;
+    for (size_t i = 0; i < matrix.Rows(); ++i) {
+        rows.emplace_back(matrix[i], matrix[i] + words);
+    }
+
+    size_t rank = 0;
+    for (size_t col = 0; (col < matrix.Cols()) && (rank < rows.size()); ++col) {
+        auto bit = static_cast<uint64_t>(1) << (col & 0x3f);
+        auto pivot = rank;
+        while ((pivot < rows.size()) && ((rows[pivot][col >> 6] & bit) == 0)) {
+            pivot += 1;
+        }
+        if (pivot == rows.size()) {
+            continue;
+        }
+
+        std::swap(rows[rank], rows[pivot]);
+        for (auto i = rank + 1; i < rows.size(); ++i) {
+            if ((rows[i][col >> 6] & bit) != 0) {
+                for (size_t w = 0; w < words; ++w) {
+                    rows[i][w] ^= rows[rank][w];
+                }
+            }
+        }
+        rank += 1;
+    }
+
+    return rank;
+}
+
+// M * Invert(M) == I, checked one row of M at a time
+static bool checkInverse(const GF2Matrix& matrix)
+{
+    GF2Matrix inverse;
+    if (matrix.Invert(inverse) != matrix.Rows()) {
+        return false;
+    }
+
+    auto n = matrix.Rows();
+    auto words = (n + 63) >> 6;
+    std::vector<uint64_t> rows(n * words);
+    std::vector<uint64_t> product(n * words);
+    for (size_t i = 0; i < n; ++i) {
+        std::copy(matrix[i], matrix[i] + words, &rows[i * words]);
+    }
+    inverse.Multiply(rows.data(), product.data(), n);
+
+    auto result = true;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t w = 0; w < words; ++w) {
+            auto expected = ((i >> 6) == w) ? (static_cast<uint64_t>(1) << (i & 0x3f)) : 0;
+            result &= product[i * words + w] == expected;
+        }
+    }
+    return result;
+}
+
+// invertible matrices around the block and word boundaries, random ones of any rank, and singular ones
+static void testMatrixInversion(EllipticCurve& curve)
+{
+    std::mt19937_64 random(409);
+    auto result = true;
+
+    for (size_t n : {1, 2, 7, 8, 9, 63, 64, 65, 163, 409}) {
+        auto words = (n + 63) >> 6;
+        auto mask = ((n & 0x3f) == 0) ? ~static_cast<uint64_t>(0) : ((static_cast<uint64_t>(1) << (n & 0x3f)) - 1);
+
+        // the identity scrambled by row additions stays invertible
+        std::vector<std::vector<uint64_t>> rows(n, std::vector<uint64_t>(words, 0));
+        for (size_t i = 0; i < n; ++i) {
+            rows[i][i >> 6] = static_cast<uint64_t>(1) << (i & 0x3f);
+        }
+        for (size_t k = 0; (n > 1) && (k < 8 * n); ++k) {
+            auto dst = random() % n;
+            auto src = (dst + 1 + random() % (n - 1)) % n;
+            for (size_t w = 0; w < words; ++w) {
+                rows[dst][w] ^= rows[src][w];
+            }
+        }
+
+        GF2Matrix invertible(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            invertible.SetRow(i, rows[i]);
+        }
+        result &= (referenceRank(invertible) == n) && checkInverse(invertible);
+
+        // one row replaced by the sum of two others, or by zero for a single row
+        auto singular = invertible;
+        auto dependent = std::vector<uint64_t>(words, 0);
+        for (size_t w = 0; (n > 2) && (w < words); ++w) {
+            dependent[w] = rows[0][w] ^ rows[1][w];
+        }
+        singular.SetRow(n - 1, dependent);
+
+        GF2Matrix unused;
+        result &= (singular.Invert(unused) == n - 1) && (referenceRank(singular) == n - 1);
+        try {
+            singular.Invert();
+            result = false;
+        } catch (const std::logic_error&) {
+        }
+
+        for (auto trial = 0; trial < 4; ++trial) {
+            GF2Matrix dense(n, n);
+            for (size_t i = 0; i < n; ++i) {
+                std::vector<uint64_t> row(words);
+                for (auto& word : row) {
+                    word = random();
+                }
+                row[words - 1] &= mask;
+                dense.SetRow(i, row);
+            }
+
+            GF2Matrix inverse;
+            auto rank = dense.Invert(inverse);
+            result &= (rank == referenceRank(dense)) && ((rank != n) || checkInverse(dense));
+        }
+    }
+
+    print("Matrix Inversion", result);
+    std::cout << std::endl;
+}
+
+// the byte-buffer conversion works in blocks of 256 elements; every element has to match the single-element path
+static void testBatchConversion(EllipticCurve& curve)
+{
+    const size_t length = (409 + 7) >> 3;
+    std::mt19937_64 random(233);
+
+    auto result = true;
+    for (size_t count : {1, 255, 256, 257, 511, 513}) {
+        std::vector<uint8_t> input(count * length);
+        for (auto& byte : input) {
+            byte = static_cast<uint8_t>(random());
+        }
+        for (size_t e = 0; e < count; ++e) {
+            input[e * length] &= 0x01;
+        }
+
+        std::vector<uint8_t> nb(input.size()), pb(input.size());
+        curve.ConvertNB(input.data(), nb.data(), count);
+        curve.ConvertPB(input.data(), pb.data(), count);
+
+        std::vector<uint8_t> expected(length);
+        for (size_t e = 0; e < count; ++e) {
+            auto element = BigNum(std::vector<uint8_t>(input.begin() + e * length, input.begin() + (e + 1) * length));
+
+            BN_bn2binpad(curve.ConvertNB(element).RawPtr(), expected.data(), length);
+            result &= std::equal(expected.begin(), expected.end(), nb.begin() + e * length);
+
+            BN_bn2binpad(curve.ConvertPB(element).RawPtr(), expected.data(), length);
+            result &= std::equal(expected.begin(), expected.end(), pb.begin() + e * length);
+        }
+
+        // converting in place and back again gives the input
+        auto roundTrip = nb;
+        curve.ConvertPB(roundTrip.data(), roundTrip.data(), count);
+        result &= roundTrip == input;
+    }
+
+    print("Batch Conversion", result);
+    std::cout << std::endl;
+}
+
+static void testBasisConversion(EllipticCurve& curve)
+{
+    std::vector<uint8_t> data = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+        0x50, 0x51,
+    };
+
+    auto pb = curve.ConvertPB(data);
+    auto nb = curve.ConvertNB(pb);
+
+    std::cout << "polynomial basis: " << pb.ToString() << std::endl;
+    std::cout << "    normal basis: " << nb.ToString() << std::endl;
+}
+
+int main(int argc, const char** argv)
+{
+    auto curve = SecgK409Curve();
+
+    testAddition(curve);
+    testMultiplication(curve);
+    testGeneratorMultiplication(curve);
+    testBatchNormalization(curve);
+    testMultiScalarMultiplication(curve);
+    testBatchMultiplication(curve);
+    testAsyncMultiplication(curve);
+    testCompression(curve);
+    testBatchEncoding(curve);
+    testBatchValidation(curve);
+    testCurveRegistry(curve);
+    testScratchArena(curve);
+    testConversionCache(curve);
+    testPolynomialArithmetic(curve);
+    testMatrixInversion(curve);
+    testBatchConversion(curve);
+    testBasisConversion(curve);
+
+    return 0;
 }
\ No newline at end of file